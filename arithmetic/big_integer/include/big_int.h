@@ -3,7 +3,11 @@
 
 #include <not_implemented.h>
 #include <pp_allocator.h>
+#include "big_int_limbs.h"
+#include "big_int_thresholds.h"
 
+#include <array>
+#include <string>
 #include <vector>
 #include <utility>
 #include <iostream>
@@ -42,12 +46,13 @@ namespace __detail {
 class big_int {
     // Call optimise after every operation!!!
     bool _sign;// 1 +  0 -
-    std::vector<unsigned int, pp_allocator<unsigned int>> _digits;
+    limb_vector _digits;
 
 public:
     enum class multiplication_rule {
         trivial,
         Karatsuba,
+        Toom3,
         SchonhageStrassen
     };
 
@@ -63,6 +68,83 @@ private:
     multiplication_rule decide_mult(size_t rhs) const noexcept;
     division_rule decide_div(size_t rhs) const noexcept;
 
+    /** |this| += |other| * BASE^shift and |this| -= |other| * BASE^shift, sign of this is flipped
+     *  if subtrahend is larger
+     */
+    void add_magnitude(const big_int& other, size_t shift);
+    void subtract_magnitude(const big_int& other, size_t shift);
+
+    /** a * b by rule, neither operand is copied
+     */
+    static big_int multiply(const big_int& a, const big_int& b, multiplication_rule rule);
+
+    /** this += a * b, or this -= a * b if subtract
+     */
+    big_int& multiply_accumulate(const big_int& a, const big_int& b, bool subtract) &;
+
+    /** |lhs| = quotient * |rhs| + remainder, signs of results are positive.
+     *  Any of quotient and remainder may be nullptr or alias lhs or rhs
+     */
+    static void divide_magnitudes(const big_int& lhs, const big_int& rhs, big_int* quotient, big_int* remainder,
+                                  division_rule rule = division_rule::trivial);
+
+    /** Limbs [begin, end) of |value| as positive number
+     */
+    static big_int limbs_range(const big_int& value, size_t begin, size_t end);
+
+    /** Burnikel-Ziegler recursion: a < b * BASE^n, b has n limbs and highest bit set
+     */
+    static void divide_2n_by_1n(const big_int& a, const big_int& b, size_t n, big_int& quotient, big_int& remainder);
+
+    static void divide_3n_by_2n(const big_int& a12, const big_int& a3, const big_int& b, const big_int& b1, const big_int& b2,
+                                size_t n, big_int& quotient, big_int& remainder);
+
+    /** floor(BASE^(2n) / divisor) by Newton iteration with doubling precision, divisor has n limbs and highest bit set
+     */
+    static big_int reciprocal(const big_int& divisor, size_t n);
+
+    /** (a, b) -> (b, a mod b). Matrix (row-major, may be nullptr) is multiplied from the left by the step,
+     *  so it keeps mapping original pair to current one
+     */
+    static void euclid_step(big_int& a, big_int& b, std::array<big_int, 4>* matrix);
+
+    /** Lehmer steps on a >= b >= 0 until b has at most target limbs, matrix (may be nullptr) is set to map
+     *  original pair to reduced one
+     */
+    static void lehmer_reduce(big_int& a, big_int& b, size_t target, std::array<big_int, 4>* matrix);
+
+    /** matrix -> by * matrix
+     */
+    static void compose(const std::array<big_int, 4>& by, std::array<big_int, 4>& matrix);
+
+    /** (a, b) -> by (a, b) made nonnegative and ordered, matrix -> by * matrix with the same changes
+     */
+    static void transform(big_int& a, big_int& b, const std::array<big_int, 4>& by, std::array<big_int, 4>* matrix);
+
+    /** Reduces a >= b >= 0 of n limbs until b has at most n / 2 + 1 limbs,
+     *  matrix (may be nullptr) is set to map original pair to reduced one
+     */
+    static void half_gcd(big_int& a, big_int& b, std::array<big_int, 4>* matrix);
+
+    /** chunk^(2^i) for i = 0, 1, ... while square of the last one can be shorter than limbs
+     */
+    static std::vector<big_int> conversion_powers(unsigned int chunk, size_t limbs, pp_allocator<unsigned int> allocator);
+
+    /** Appends |value| in radix, padded with zeros up to width, by dividing it by powers[level - 1] recursively
+     */
+    static void append_digits(std::string& out, const big_int& value, const std::vector<big_int>& powers, size_t level,
+                              unsigned int radix, size_t chunk_digits, size_t width);
+
+    /** Builds number from count chunks (least significant first) in base powers[0] by multiplying halves by powers
+     */
+    static big_int from_chunks(const unsigned int* chunks, size_t count, const std::vector<big_int>& powers, pp_allocator<unsigned int> allocator);
+
+    /** For limbs built in place by arithmetic
+     */
+    explicit big_int(const limb_vector& digits, bool sign = true);
+
+    explicit big_int(limb_vector&& digits, bool sign = true) noexcept;
+
 public:
     using value_type = unsigned int;
 
@@ -73,6 +155,8 @@ public:
 
     explicit big_int(std::vector<unsigned int, pp_allocator<unsigned int>>&& digits, bool sign = true) noexcept;
 
+    /** Digits of radix in [2, 36] are 0-9 and case-insensitive a-z, optionally preceded by sign
+     */
     explicit big_int(const std::string& num, unsigned int radix = 10, pp_allocator<unsigned int> = pp_allocator<unsigned int>());
 
     template<std::integral Num>
@@ -82,6 +166,10 @@ public:
 
     explicit operator bool() const noexcept;//false if 0 , else true
 
+    /** Number of significant bits of absolute value, 0 for 0
+     */
+    size_t bit_length() const noexcept;
+
     big_int& operator++() &;
     big_int operator++(int);
 
@@ -115,11 +203,34 @@ public:
 
     big_int& modulo_assign(const big_int& other, division_rule rule = division_rule::trivial) &;
 
-    big_int operator+(const big_int& other) const;
-    big_int operator-(const big_int& other) const;
-    big_int operator*(const big_int& other) const;
-    big_int operator/(const big_int& other) const;
-    big_int operator%(const big_int& other) const;
+    /** this += a * b, short products are accumulated straight into limbs of this without a temporary
+     */
+    big_int& addmul(const big_int& a, const big_int& b) &;
+
+    /** this -= a * b, same as addmul
+     */
+    big_int& submul(const big_int& a, const big_int& b) &;
+
+    /** Overloads taking rvalues reuse limbs of the expiring operand for the result
+     */
+    big_int operator+(const big_int& other) const &;
+    big_int operator+(const big_int& other) &&;
+    big_int operator+(big_int&& other) const &;
+    big_int operator+(big_int&& other) &&;
+
+    big_int operator-(const big_int& other) const &;
+    big_int operator-(const big_int& other) &&;
+    big_int operator-(big_int&& other) const &;
+    big_int operator-(big_int&& other) &&;
+
+    big_int operator*(const big_int& other) const &;
+    big_int operator*(const big_int& other) &&;
+
+    big_int operator/(const big_int& other) const &;
+    big_int operator/(const big_int& other) &&;
+
+    big_int operator%(const big_int& other) const &;
+    big_int operator%(const big_int& other) &&;
 
     std::strong_ordering operator<=>(const big_int& other) const noexcept;
 
@@ -145,9 +256,56 @@ public:
     friend std::ostream& operator<<(std::ostream& stream, big_int const& value);
     friend std::istream& operator>>(std::istream& stream, big_int& value);
 
-    std::string to_string() const;
+    /** Subquadratic if multiplication and division are, radix is in [2, 36]
+     */
+    std::string to_string(unsigned int radix = 10) const;
 
     friend big_int multiply_karatsuba(const big_int &a, const big_int &b);
+
+    /** Splits operands into thirds and evaluates at 0, 1, -1, -2 and infinity (Bodrato's sequence)
+     */
+    friend big_int multiply_toom3(const big_int &a, const big_int &b);
+
+    /** Rule SchonhageStrassen: number-theoretic transforms of 16-bit pieces modulo three 31-bit primes,
+     *  product coefficients are restored by Chinese remainder theorem. Operands whose product is longer than
+     *  2^25 limbs are split by Toom-3 first
+     */
+    friend big_int multiply_ntt(const big_int &a, const big_int &b);
+
+    /** Greatest common divisor of |a| and |b|: half-gcd recursion for long operands,
+     *  Lehmer steps on leading bits for shorter ones and binary gcd for the last two limbs
+     */
+    friend big_int gcd(const big_int &a, const big_int &b);
+
+    class montgomery_context;
+
+    /** this^exponent mod modulus in [0, modulus) for exponent >= 0 and modulus > 0 by sliding window.
+     *  Odd moduli go through Montgomery multiplication with context built for this call, even ones through
+     *  division. With constant_time the window is fixed and sequence of operations, table lookups and
+     *  reductions don't depend on exponent bits, only on its length in limbs; modulus must be odd then
+     */
+    big_int pow_mod(const big_int& exponent, const big_int& modulus, bool constant_time = false) const;
+
+    /** Same with precomputed context, for many exponentiations modulo the same number
+     */
+    big_int pow_mod(const big_int& exponent, const montgomery_context& context, bool constant_time = false) const;
+};
+
+/** Montgomery form x R mod m for odd modulus m > 1 and R = 2^(word bits * words), where word is the widest
+ *  multiplication kernels have. Keeps m, R^2 mod m and -m^-1 mod 2^(word bits)
+ */
+class big_int::montgomery_context final {
+    big_int _modulus;
+    big_int _r_squared;
+    unsigned long long _inverse;
+    size_t _words;
+
+    friend class big_int;
+
+public:
+    explicit montgomery_context(const big_int& modulus);
+
+    const big_int& modulus() const noexcept;
 };
 
 template<class alloc>
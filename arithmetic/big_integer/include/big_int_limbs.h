@@ -0,0 +1,246 @@
+#ifndef MP_OS_BIG_INT_LIMBS_H
+#define MP_OS_BIG_INT_LIMBS_H
+
+#include <pp_allocator.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+/** Limbs of big_int: up to inline_capacity of them are stored in the object itself, longer values spill
+ *  to a vector from the allocator and stay there until assigned from a moved value. Interface is the
+ *  subset of std::vector big_int uses, iterators are plain pointers
+ */
+class limb_vector final {
+public:
+    using value_type = unsigned int;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using allocator_type = pp_allocator<unsigned int>;
+    using iterator = unsigned int *;
+    using const_iterator = const unsigned int *;
+
+    static constexpr size_t inline_capacity = 4;
+
+private:
+    // holds allocator even when limbs are inline
+    std::vector<unsigned int, allocator_type> _heap;
+    std::array<unsigned int, inline_capacity> _inline{};
+    size_t _size = 0;// of inline limbs
+    bool _on_heap = false;
+
+    void spill(size_t capacity) {
+        _heap.reserve(std::max(capacity, 2 * inline_capacity));
+        _heap.assign(_inline.begin(), _inline.begin() + static_cast<difference_type>(_size));
+        _on_heap = true;
+    }
+
+    void reset() noexcept {
+        _size = 0;
+        _on_heap = false;
+    }
+
+public:
+    explicit limb_vector(const allocator_type &allocator = allocator_type()) noexcept : _heap(allocator) {}
+
+    limb_vector(size_t count, unsigned int value, const allocator_type &allocator = allocator_type()) : _heap(allocator) {
+        assign(count, value);
+    }
+
+    template<std::forward_iterator It>
+    limb_vector(It first, It last, const allocator_type &allocator = allocator_type()) : _heap(allocator) {
+        assign(first, last);
+    }
+
+    limb_vector(std::initializer_list<unsigned int> values, const allocator_type &allocator = allocator_type()) : _heap(allocator) {
+        assign(values.begin(), values.end());
+    }
+
+    explicit limb_vector(const std::vector<unsigned int, allocator_type> &digits) : _heap(digits.get_allocator()) {
+        assign(digits.begin(), digits.end());
+    }
+
+    explicit limb_vector(std::vector<unsigned int, allocator_type> &&digits) noexcept : _heap(std::move(digits)), _on_heap(true) {}
+
+    limb_vector(const limb_vector &other) : _heap(other._heap.get_allocator()) {
+        assign(other.begin(), other.end());
+    }
+
+    limb_vector(limb_vector &&other) noexcept : _heap(std::move(other._heap)), _inline(other._inline),
+                                                _size(other._size), _on_heap(other._on_heap) {
+        other.reset();
+    }
+
+    limb_vector &operator=(const limb_vector &other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    limb_vector &operator=(limb_vector &&other) noexcept {
+        if (this != &other) {
+            _heap = std::move(other._heap);
+            _inline = other._inline;
+            _size = other._size;
+            _on_heap = other._on_heap;
+            other.reset();
+        }
+        return *this;
+    }
+
+    limb_vector &operator=(std::initializer_list<unsigned int> values) {
+        assign(values.begin(), values.end());
+        return *this;
+    }
+
+    ~limb_vector() noexcept = default;
+
+    allocator_type get_allocator() const noexcept {
+        return _heap.get_allocator();
+    }
+
+    unsigned int *data() noexcept {
+        return _on_heap ? _heap.data() : _inline.data();
+    }
+
+    const unsigned int *data() const noexcept {
+        return _on_heap ? _heap.data() : _inline.data();
+    }
+
+    size_t size() const noexcept {
+        return _on_heap ? _heap.size() : _size;
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    size_t capacity() const noexcept {
+        return _on_heap ? _heap.capacity() : inline_capacity;
+    }
+
+    iterator begin() noexcept { return data(); }
+    iterator end() noexcept { return data() + size(); }
+    const_iterator begin() const noexcept { return data(); }
+    const_iterator end() const noexcept { return data() + size(); }
+
+    unsigned int &operator[](size_t index) noexcept { return data()[index]; }
+    const unsigned int &operator[](size_t index) const noexcept { return data()[index]; }
+
+    unsigned int &back() noexcept { return data()[size() - 1]; }
+    const unsigned int &back() const noexcept { return data()[size() - 1]; }
+
+    void reserve(size_t capacity) {
+        if (_on_heap) {
+            _heap.reserve(capacity);
+        } else if (capacity > inline_capacity) {
+            spill(capacity);
+        }
+    }
+
+    void push_back(unsigned int value) {
+        if (!_on_heap) {
+            if (_size < inline_capacity) {
+                _inline[_size++] = value;
+                return;
+            }
+            spill(2 * inline_capacity);
+        }
+        _heap.push_back(value);
+    }
+
+    void pop_back() noexcept {
+        if (_on_heap) {
+            _heap.pop_back();
+        } else {
+            --_size;
+        }
+    }
+
+    void clear() noexcept {
+        if (_on_heap) {
+            _heap.clear();
+        } else {
+            _size = 0;
+        }
+    }
+
+    void resize(size_t count, unsigned int value = 0) {
+        if (!_on_heap) {
+            if (count <= inline_capacity) {
+                std::fill(_inline.begin() + static_cast<difference_type>(std::min(_size, count)),
+                          _inline.begin() + static_cast<difference_type>(count), value);
+                _size = count;
+                return;
+            }
+            spill(count);
+        }
+        _heap.resize(count, value);
+    }
+
+    void assign(size_t count, unsigned int value) {
+        if (!_on_heap && count <= inline_capacity) {
+            std::fill(_inline.begin(), _inline.begin() + static_cast<difference_type>(count), value);
+            _size = count;
+            return;
+        }
+        _heap.assign(count, value);
+        _on_heap = true;
+    }
+
+    template<std::forward_iterator It>
+    void assign(It first, It last) {
+        auto count = static_cast<size_t>(std::distance(first, last));
+        if (!_on_heap && count <= inline_capacity) {
+            std::copy(first, last, _inline.begin());
+            _size = count;
+            return;
+        }
+        if (!_on_heap) {
+            _heap.reserve(count);
+        }
+        _heap.assign(first, last);
+        _on_heap = true;
+    }
+
+    iterator insert(const_iterator position, size_t count, unsigned int value) {
+        auto index = static_cast<difference_type>(position - data());
+        if (!_on_heap) {
+            if (_size + count <= inline_capacity) {
+                std::copy_backward(_inline.begin() + index, _inline.begin() + static_cast<difference_type>(_size),
+                                   _inline.begin() + static_cast<difference_type>(_size + count));
+                std::fill_n(_inline.begin() + index, count, value);
+                _size += count;
+                return data() + index;
+            }
+            spill(_size + count);
+        }
+        return _heap.data() + (_heap.insert(_heap.begin() + index, count, value) - _heap.begin());
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        auto index = static_cast<difference_type>(first - data());
+        auto count = static_cast<difference_type>(last - first);
+        if (_on_heap) {
+            _heap.erase(_heap.begin() + index, _heap.begin() + index + count);
+        } else {
+            std::copy(_inline.begin() + index + count, _inline.begin() + static_cast<difference_type>(_size),
+                      _inline.begin() + index);
+            _size -= static_cast<size_t>(count);
+        }
+        return data() + index;
+    }
+
+    void swap(limb_vector &other) noexcept {
+        std::swap(_heap, other._heap);
+        std::swap(_inline, other._inline);
+        std::swap(_size, other._size);
+        std::swap(_on_heap, other._on_heap);
+    }
+};
+
+#endif //MP_OS_BIG_INT_LIMBS_H
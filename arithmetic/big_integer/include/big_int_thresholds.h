@@ -0,0 +1,20 @@
+#ifndef MP_OS_BIG_INT_THRESHOLDS_H
+#define MP_OS_BIG_INT_THRESHOLDS_H
+
+#include <cstddef>
+#include <cstdint>
+
+/** Crossover sizes in limbs of the shorter operand for big_int::decide_mult
+ *  and of the shorter of divisor and quotient for big_int::decide_div.
+ *  SIZE_MAX means the rule never won in the tuner's search range and is not chosen.
+ *  Regenerate for current machine with mp_os_arthmtc_bg_intgr_tn <path to this file>
+ */
+namespace big_int_thresholds {
+    constexpr size_t karatsuba_multiplication = 114;
+    constexpr size_t toom3_multiplication = 1671;
+    constexpr size_t ntt_multiplication = 12355;
+    constexpr size_t burnikel_ziegler_division = 144;
+    constexpr size_t newton_division = SIZE_MAX;
+}// namespace big_int_thresholds
+
+#endif //MP_OS_BIG_INT_THRESHOLDS_H
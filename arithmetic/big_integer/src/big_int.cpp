@@ -1,49 +1,1074 @@
 #include "../include/big_int.h"
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cmath>
+#include <limits>
+#include <stdexcept>
 #include <sstream>
 #include <string>
 
+// 64-bit word kernels need 128-bit products, MP_OS_BIG_INT_NARROW_KERNELS keeps 32-bit ones everywhere
+#if defined(__SIZEOF_INT128__) && !defined(MP_OS_BIG_INT_NARROW_KERNELS)
+#define MP_OS_BIG_INT_WIDE_KERNELS
+#endif
+
 unsigned long long BASE = 1ULL << (8 * sizeof(unsigned int));
 
 
-bool is_zero(const std::vector<unsigned int, pp_allocator<unsigned int>> &digits) {
+bool is_zero(const limb_vector &digits) {
     return digits.size() == 1 && digits[0] == 0;
 }
 
-void optimise(std::vector<unsigned int, pp_allocator<unsigned int>> &digits) {
+void optimise(limb_vector &digits) {
     while (digits.size() > 1 && digits.back() == 0) {
         digits.pop_back();
     }
 }
 
-std::string big_int::to_string() const {
-    if (is_zero(_digits)) return "0";
+namespace {
+    using limb = unsigned int;
+    using double_limb = unsigned long long;
+    using digits_vector = limb_vector;
 
-    std::string res;
-    big_int tmp = *this;
-    tmp._sign = true;
-    while (tmp) {
-        auto val = tmp % 10;
-        res += static_cast<char>('0' + val._digits[0]);
-        tmp /= 10;
+    constexpr size_t limb_bits = 8 * sizeof(limb);
+
+    // below this many limbs radix conversion falls back to one-limb multiplications and divisions
+    constexpr size_t conversion_threshold = 32;
+
+    constexpr char digit_chars[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+#ifdef MP_OS_BIG_INT_WIDE_KERNELS
+    /** Wide kernels see each pair of limbs as one 64-bit word and keep products and carries in 128 bits,
+     *  odd limb at the end is left to 32-bit loops. Words are assembled from limbs explicitly, so limb
+     *  layout doesn't depend on endianness and compilers still emit single loads on little-endian targets
+     */
+    using word = unsigned long long;
+    __extension__ typedef unsigned __int128 double_word;
+
+    constexpr size_t word_bits = 8 * sizeof(word);
+
+    inline word load_word(const limb *p) noexcept {
+        return static_cast<word>(p[0]) | static_cast<word>(p[1]) << limb_bits;
+    }
+
+    inline void store_word(limb *p, word value) noexcept {
+        p[0] = static_cast<limb>(value);
+        p[1] = static_cast<limb>(value >> limb_bits);
+    }
+
+    // row[0, 2 * words) += m * b[0, 2 * words), returns carry word
+    inline word multiply_add_words(limb *row, const limb *b, size_t words, word m) noexcept {
+        double_word carry = 0;
+        size_t j = 0;
+        for (; j + 4 <= words; j += 4) {
+            double_word p0 = static_cast<double_word>(m) * load_word(b + 2 * j) + load_word(row + 2 * j) + carry;
+            store_word(row + 2 * j, static_cast<word>(p0));
+            double_word p1 = static_cast<double_word>(m) * load_word(b + 2 * j + 2) + load_word(row + 2 * j + 2) + (p0 >> word_bits);
+            store_word(row + 2 * j + 2, static_cast<word>(p1));
+            double_word p2 = static_cast<double_word>(m) * load_word(b + 2 * j + 4) + load_word(row + 2 * j + 4) + (p1 >> word_bits);
+            store_word(row + 2 * j + 4, static_cast<word>(p2));
+            double_word p3 = static_cast<double_word>(m) * load_word(b + 2 * j + 6) + load_word(row + 2 * j + 6) + (p2 >> word_bits);
+            store_word(row + 2 * j + 6, static_cast<word>(p3));
+            carry = p3 >> word_bits;
+        }
+        for (; j < words; ++j) {
+            double_word current = static_cast<double_word>(m) * load_word(b + 2 * j) + load_word(row + 2 * j) + carry;
+            store_word(row + 2 * j, static_cast<word>(current));
+            carry = current >> word_bits;
+        }
+        return static_cast<word>(carry);
+    }
+#endif
+
+    int compare_magnitudes(const limb *a, size_t a_size, const limb *b, size_t b_size) noexcept {
+        if (a_size != b_size) {
+            return a_size < b_size ? -1 : 1;
+        }
+
+        for (size_t i = a_size; i-- > 0;) {
+            if (a[i] != b[i]) {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    // a /= d, returns remainder
+    limb divide_by_limb(limb *a, size_t size, limb d) noexcept {
+        double_limb remainder = 0;
+        for (size_t i = size; i-- > 0;) {
+            double_limb current = (remainder << limb_bits) | a[i];
+            a[i] = static_cast<limb>(current / d);
+            remainder = current % d;
+        }
+        return static_cast<limb>(remainder);
+    }
+
+    // a = a * m + add, returns carry
+    limb multiply_by_limb_add(limb *a, size_t size, limb m, limb add) noexcept {
+        double_limb carry = add;
+        for (size_t i = 0; i < size; ++i) {
+            double_limb current = static_cast<double_limb>(a[i]) * m + carry;
+            a[i] = static_cast<limb>(current);
+            carry = current >> limb_bits;
+        }
+        return static_cast<limb>(carry);
+    }
+
+    /** Knuth, TAOCP vol. 2, 4.3.1, algorithm D.
+     *  u has u_size >= v_size limbs, v has v_size >= 2 limbs and nonzero top limb,
+     *  q receives u_size - v_size + 1 limbs, r receives v_size limbs
+     */
+    void divide_knuth(const limb *u, size_t u_size, const limb *v, size_t v_size, limb *q, limb *r,
+                      const pp_allocator<unsigned int> &allocator) {
+        int shift = std::countl_zero(v[v_size - 1]);
+
+        digits_vector vn(v_size, 0, allocator);
+        digits_vector un(u_size + 1, 0, allocator);
+
+        for (size_t i = v_size; i-- > 0;) {
+            vn[i] = v[i] << shift;
+            if (shift != 0 && i > 0) vn[i] |= v[i - 1] >> (limb_bits - shift);
+        }
+
+        un[u_size] = shift != 0 ? u[u_size - 1] >> (limb_bits - shift) : 0;
+        for (size_t i = u_size; i-- > 0;) {
+            un[i] = u[i] << shift;
+            if (shift != 0 && i > 0) un[i] |= u[i - 1] >> (limb_bits - shift);
+        }
+
+        constexpr double_limb base = 1ULL << limb_bits;
+        const double_limb top = vn[v_size - 1];
+        const double_limb second = vn[v_size - 2];
+
+        for (size_t j = u_size - v_size + 1; j-- > 0;) {
+            double_limb numerator = (static_cast<double_limb>(un[j + v_size]) << limb_bits) | un[j + v_size - 1];
+            double_limb q_hat = numerator / top;
+            double_limb r_hat = numerator % top;
+
+            while (q_hat >= base || q_hat * second > ((r_hat << limb_bits) | un[j + v_size - 2])) {
+                --q_hat;
+                r_hat += top;
+                if (r_hat >= base) break;
+            }
+
+            double_limb carry = 0, borrow = 0;
+            for (size_t i = 0; i < v_size; ++i) {
+                double_limb product = q_hat * vn[i] + carry;
+                carry = product >> limb_bits;
+                double_limb difference = static_cast<double_limb>(un[i + j]) - static_cast<limb>(product) - borrow;
+                un[i + j] = static_cast<limb>(difference);
+                borrow = difference >> (2 * limb_bits - 1);
+            }
+            double_limb difference = static_cast<double_limb>(un[j + v_size]) - carry - borrow;
+            un[j + v_size] = static_cast<limb>(difference);
+            borrow = difference >> (2 * limb_bits - 1);
+
+            q[j] = static_cast<limb>(q_hat);
+
+            // q_hat was one too large, happens with probability about 2 / base
+            if (borrow != 0) {
+                --q[j];
+                carry = 0;
+                for (size_t i = 0; i < v_size; ++i) {
+                    double_limb sum = static_cast<double_limb>(un[i + j]) + vn[i] + carry;
+                    un[i + j] = static_cast<limb>(sum);
+                    carry = sum >> limb_bits;
+                }
+                un[j + v_size] += static_cast<limb>(carry);
+            }
+        }
+
+        for (size_t i = 0; i < v_size; ++i) {
+            r[i] = un[i] >> shift;
+            if (shift != 0) r[i] |= un[i + 1] << (limb_bits - shift);
+        }
+    }
+
+    // row[0, size) += a[0, size) * m, returns carry
+    limb multiply_add_row(limb *row, const limb *a, size_t size, limb m) noexcept {
+        double_limb carry = 0;
+        for (size_t j = 0; j < size; ++j) {
+            double_limb current = static_cast<double_limb>(a[j]) * m + row[j] + carry;
+            row[j] = static_cast<limb>(current);
+            carry = current >> limb_bits;
+        }
+        return static_cast<limb>(carry);
+    }
+
+    // result has a_size + b_size limbs and is zero-filled
+    void multiply_schoolbook(const limb *a, size_t a_size, const limb *b, size_t b_size, limb *result) noexcept {
+#ifdef MP_OS_BIG_INT_WIDE_KERNELS
+        // even prefixes are multiplied by words, then odd top limbs of a and b add one row each
+        size_t a_words = a_size / 2, b_words = b_size / 2;
+        if (b_words != 0) {
+            for (size_t i = 0; i < a_words; ++i) {
+                store_word(result + 2 * (i + b_words), multiply_add_words(result + 2 * i, b, b_words, load_word(a + 2 * i)));
+            }
+        }
+        if (a_size % 2 != 0) {
+            result[a_size - 1 + 2 * b_words] = multiply_add_row(result + a_size - 1, b, 2 * b_words, a[a_size - 1]);
+        }
+        if (b_size % 2 != 0) {
+            result[a_size + b_size - 1] = multiply_add_row(result + b_size - 1, a, a_size, b[b_size - 1]);
+        }
+#else
+        for (size_t i = 0; i < a_size; ++i) {
+            result[i + b_size] = multiply_add_row(result + i, b, b_size, a[i]);
+        }
+#endif
+    }
+
+    // a += b for a_size >= b_size, returns carry out of a
+    limb add_in_place(limb *a, size_t a_size, const limb *b, size_t b_size) noexcept {
+        double_limb carry = 0;
+        size_t i = 0;
+#ifdef MP_OS_BIG_INT_WIDE_KERNELS
+        double_word wide_carry = 0;
+        for (; i + 1 < b_size; i += 2) {
+            wide_carry += static_cast<double_word>(load_word(a + i)) + load_word(b + i);
+            store_word(a + i, static_cast<word>(wide_carry));
+            wide_carry >>= word_bits;
+        }
+        carry = static_cast<double_limb>(wide_carry);
+#endif
+        for (; i < b_size; ++i) {
+            carry += static_cast<double_limb>(a[i]) + b[i];
+            a[i] = static_cast<limb>(carry);
+            carry >>= limb_bits;
+        }
+        for (; carry != 0 && i < a_size; ++i) {
+            carry += a[i];
+            a[i] = static_cast<limb>(carry);
+            carry >>= limb_bits;
+        }
+        return static_cast<limb>(carry);
+    }
+
+    // a -= b for a_size >= b_size, returns borrow out of a
+    limb subtract_in_place(limb *a, size_t a_size, const limb *b, size_t b_size) noexcept {
+        limb borrow = 0;
+        size_t i = 0;
+#ifdef MP_OS_BIG_INT_WIDE_KERNELS
+        for (; i + 1 < b_size; i += 2) {
+            double_word current = static_cast<double_word>(load_word(a + i)) - load_word(b + i) - borrow;
+            store_word(a + i, static_cast<word>(current));
+            borrow = static_cast<limb>(current >> (2 * word_bits - 1));
+        }
+#endif
+        for (; i < b_size; ++i) {
+            double_limb current = static_cast<double_limb>(a[i]) - b[i] - borrow;
+            a[i] = static_cast<limb>(current);
+            borrow = static_cast<limb>(current >> (2 * limb_bits - 1));
+        }
+        for (; borrow != 0 && i < a_size; ++i) {
+            borrow = a[i] == 0 ? 1 : 0;
+            --a[i];
+        }
+        return borrow;
+    }
+
+    // a <<= shift for 0 < shift < limb_bits, returns bits shifted out of the top limb
+    limb shift_left_in_place(limb *a, size_t size, size_t shift) noexcept {
+        limb carry = 0;
+        size_t i = 0;
+#ifdef MP_OS_BIG_INT_WIDE_KERNELS
+        for (; i + 1 < size; i += 2) {
+            word current = load_word(a + i);
+            store_word(a + i, current << shift | carry);
+            carry = static_cast<limb>(current >> (word_bits - shift));
+        }
+#endif
+        for (; i < size; ++i) {
+            limb current = a[i];
+            a[i] = current << shift | carry;
+            carry = current >> (limb_bits - shift);
+        }
+        return carry;
+    }
+
+    // a >>= shift for 0 < shift < limb_bits, bits shifted out of the bottom limb are dropped
+    void shift_right_in_place(limb *a, size_t size, size_t shift) noexcept {
+        limb carry = 0;
+        size_t i = size;
+#ifdef MP_OS_BIG_INT_WIDE_KERNELS
+        if (i % 2 != 0) {
+            limb current = a[--i];
+            a[i] = current >> shift;
+            carry = current << (limb_bits - shift);
+        }
+        for (; i >= 2; i -= 2) {
+            word current = load_word(a + i - 2);
+            store_word(a + i - 2, current >> shift | static_cast<word>(carry) << limb_bits);
+            carry = static_cast<limb>(current) << (limb_bits - shift);
+        }
+#endif
+        while (i-- > 0) {
+            limb current = a[i];
+            a[i] = current >> shift | carry;
+            carry = current << (limb_bits - shift);
+        }
+    }
+
+    // result[0, size) += a * b for size >= a_size + b_size, returns carry out of result
+    limb multiply_add(limb *result, size_t size, const limb *a, size_t a_size, const limb *b, size_t b_size) noexcept {
+        limb carry = 0;
+        size_t i = 0;
+#ifdef MP_OS_BIG_INT_WIDE_KERNELS
+        // same split as multiply_schoolbook, but row carries are added rather than stored
+        size_t b_words = b_size / 2;
+        if (b_words != 0) {
+            for (; i + 1 < a_size; i += 2) {
+                std::array<limb, 2> top{};
+                store_word(top.data(), multiply_add_words(result + i, b, b_words, load_word(a + i)));
+                carry += add_in_place(result + i + 2 * b_words, size - i - 2 * b_words, top.data(), 2);
+            }
+            if (b_size % 2 != 0) {
+                limb top = multiply_add_row(result + b_size - 1, a, i, b[b_size - 1]);
+                carry += add_in_place(result + b_size - 1 + i, size - (b_size - 1 + i), &top, 1);
+            }
+        }
+#endif
+        for (; i < a_size; ++i) {
+            limb top = multiply_add_row(result + i, b, b_size, a[i]);
+            carry += add_in_place(result + i + b_size, size - i - b_size, &top, 1);
+        }
+        return carry;
+    }
+
+    // result = |a - b| of a_size limbs for a_size >= b_size, returns true if a < b
+    bool subtract_absolute(const limb *a, size_t a_size, const limb *b, size_t b_size, limb *result) noexcept {
+        size_t a_used = a_size;
+        while (a_used > b_size && a[a_used - 1] == 0) {
+            --a_used;
+        }
+
+        bool negative = a_used == b_size && compare_magnitudes(a, b_size, b, b_size) < 0;
+        if (negative) {
+            std::copy(b, b + b_size, result);
+            std::fill(result + b_size, result + a_size, 0);
+            subtract_in_place(result, a_size, a, b_size);
+        } else {
+            std::copy(a, a + a_size, result);
+            subtract_in_place(result, a_size, b, b_size);
+        }
+        return negative;
+    }
+
+    /** Limbs of scratch needed by multiply_karatsuba_kernel for operands of size limbs
+     */
+    size_t karatsuba_scratch_size(size_t size) noexcept {
+        size_t total = 0;
+        while (size >= big_int_thresholds::karatsuba_multiplication && size >= 4) {
+            size_t high = size - size / 2;
+            total += 6 * high + 1;
+            size = high;
+        }
+        return total;
+    }
+
+    /** result[0, 2 size) = a * b for operands of size limbs. Differences |a1 - a0| and |b1 - b0| keep subproducts
+     *  at high half size, so every level takes fixed part of scratch and passes the rest down
+     */
+    void multiply_karatsuba_kernel(const limb *a, const limb *b, size_t size, limb *result, limb *scratch, bool split) noexcept {
+        if (size < 4 || (!split && size < big_int_thresholds::karatsuba_multiplication)) {
+            std::fill(result, result + 2 * size, 0);
+            multiply_schoolbook(a, size, b, size, result);
+            return;
+        }
+
+        size_t low = size / 2, high = size - low;
+
+        limb *a_difference = scratch;
+        limb *b_difference = a_difference + high;
+        limb *middle_product = b_difference + high;
+        limb *middle = middle_product + 2 * high;
+        limb *rest = middle + 2 * high + 1;
+
+        // z0 and z2 land in their final places
+        multiply_karatsuba_kernel(a, b, low, result, rest, false);
+        multiply_karatsuba_kernel(a + low, b + low, high, result + 2 * low, rest, false);
+
+        bool a_negative = subtract_absolute(a + low, high, a, low, a_difference);
+        bool b_negative = subtract_absolute(b + low, high, b, low, b_difference);
+        multiply_karatsuba_kernel(a_difference, b_difference, high, middle_product, rest, false);
+
+        // z1 = z0 + z2 - (a1 - a0)(b1 - b0)
+        std::copy(result + 2 * low, result + 2 * size, middle);
+        middle[2 * high] = add_in_place(middle, 2 * high, result, 2 * low);
+        if (a_negative == b_negative) {
+            subtract_in_place(middle, 2 * high + 1, middle_product, 2 * high);
+        } else {
+            add_in_place(middle, 2 * high + 1, middle_product, 2 * high);
+        }
+
+        add_in_place(result + low, 2 * size - low, middle, 2 * high + 1);
+    }
+
+    /** Limbs of scratch needed by multiply_spans for a_size >= b_size
+     */
+    size_t multiply_scratch_size(size_t a_size, size_t b_size) noexcept {
+        if (b_size == 0 || a_size == b_size) {
+            return karatsuba_scratch_size(b_size) + 6 * b_size + 1;
+        }
+        size_t rest = a_size % b_size;
+        size_t own = 2 * b_size + karatsuba_scratch_size(b_size) + 6 * b_size + 1;
+        return rest == 0 ? own : std::max(own, 2 * b_size + multiply_scratch_size(b_size, rest));
+    }
+
+    /** result[0, a_size + b_size) = a * b for a_size >= b_size: longer operand is cut into pieces of b_size limbs
+     *  that are multiplied by Karatsuba kernel and added up
+     */
+    void multiply_spans(const limb *a, size_t a_size, const limb *b, size_t b_size, limb *result, limb *scratch) noexcept {
+        if (a_size == b_size) {
+            multiply_karatsuba_kernel(a, b, b_size, result, scratch, true);
+            return;
+        }
+
+        std::fill(result, result + a_size + b_size, 0);
+        limb *product = scratch;
+        limb *rest = product + 2 * b_size;
+
+        for (size_t offset = 0; offset < a_size; offset += b_size) {
+            size_t piece = std::min(b_size, a_size - offset);
+            if (piece == b_size) {
+                multiply_karatsuba_kernel(a + offset, b, b_size, product, rest, true);
+            } else {
+                multiply_spans(b, b_size, a + offset, piece, product, rest);
+            }
+            add_in_place(result + offset, a_size + b_size - offset, product, piece + b_size);
+        }
+    }
+
+    /** Prime p = c * 2^k + 1 < 2^31 with generator g, products are reduced by Montgomery's method with R = 2^32
+     */
+    struct ntt_prime {
+        limb p;
+        limb g;
+        limb p_inv_neg;// -p^-1 mod R
+        limb r2;// R^2 mod p
+
+        constexpr ntt_prime(limb p, limb g) noexcept: p(p), g(g), p_inv_neg(0), r2(0) {
+            limb inverse = p;
+            for (int i = 0; i < 5; ++i) {
+                inverse *= 2 - p * inverse;
+            }
+            p_inv_neg = static_cast<limb>(0) - inverse;
+            r2 = static_cast<limb>((std::numeric_limits<double_limb>::max() % p + 1) % p);
+        }
+
+        // t * R^-1 mod p for t < p * R
+        limb reduce(double_limb t) const noexcept {
+            limb m = static_cast<limb>(t) * p_inv_neg;
+            limb u = static_cast<limb>((t + static_cast<double_limb>(m) * p) >> limb_bits);
+            return u >= p ? u - p : u;
+        }
+
+        limb multiply(limb a, limb b) const noexcept {
+            return reduce(static_cast<double_limb>(a) * b);
+        }
+
+        limb to_montgomery(limb a) const noexcept {
+            return multiply(a, r2);
+        }
+
+        limb add(limb a, limb b) const noexcept {
+            limb sum = a + b;
+            return sum >= p ? sum - p : sum;
+        }
+
+        limb subtract(limb a, limb b) const noexcept {
+            return a >= b ? a - b : a + p - b;
+        }
+
+        // all in Montgomery form
+        limb power(limb base, double_limb exponent) const noexcept {
+            limb result = to_montgomery(1);
+            while (exponent != 0) {
+                if (exponent & 1) result = multiply(result, base);
+                base = multiply(base, base);
+                exponent >>= 1;
+            }
+            return result;
+        }
+    };
+
+    // ascending, so that every residue is below next prime and Garner's steps need no extra reduction
+    constexpr std::array<ntt_prime, 3> ntt_primes = {ntt_prime(469762049, 3), ntt_prime(1811939329, 13),
+                                                     ntt_prime(2013265921, 31)};
+
+    /** every prime is 1 mod 2^26, and coefficient of 2^25 products of 32-bit limbs is below
+     *  product of the primes (about 2^90), so transform has at most that many whole limbs
+     */
+    constexpr size_t ntt_max_length = size_t(1) << 26;
+
+    /** roots[half + j] = w^j for primitive root w of order 2 * half, for every half < size, in Montgomery form.
+     *  Built once per transform size, every stage then reads its twiddles contiguously
+     */
+    void ntt_roots(limb *roots, size_t size, const ntt_prime &prime, bool inverse) noexcept {
+        limb root = prime.power(prime.to_montgomery(prime.g), (prime.p - 1) / size);
+        if (inverse) root = prime.power(root, size - 1);
+
+        size_t half = size / 2;
+        roots[half] = prime.to_montgomery(1);
+        for (size_t j = 1; j < half; ++j) {
+            roots[half + j] = prime.multiply(roots[half + j - 1], root);
+        }
+        for (half /= 2; half > 0; half /= 2) {
+            for (size_t j = 0; j < half; ++j) {
+                roots[half + j] = roots[2 * (half + j)];
+            }
+        }
+    }
+
+    // stages that work on shorter spans are finished block by block, so that block stays in cache
+    constexpr size_t ntt_block = 4096;
+
+    void ntt_forward_stage(limb *values, size_t size, size_t half, const ntt_prime &prime, const limb *roots) noexcept {
+        for (size_t i = 0; i < size; i += 2 * half) {
+            for (size_t j = 0; j < half; ++j) {
+                limb u = values[i + j], v = values[i + j + half];
+                values[i + j] = prime.add(u, v);
+                values[i + j + half] = prime.multiply(prime.subtract(u, v), roots[half + j]);
+            }
+        }
+    }
+
+    void ntt_inverse_stage(limb *values, size_t size, size_t half, const ntt_prime &prime, const limb *roots) noexcept {
+        for (size_t i = 0; i < size; i += 2 * half) {
+            for (size_t j = 0; j < half; ++j) {
+                limb u = values[i + j], v = prime.multiply(values[i + j + half], roots[half + j]);
+                values[i + j] = prime.add(u, v);
+                values[i + j + half] = prime.subtract(u, v);
+            }
+        }
+    }
+
+    /** Decimation in frequency, leaves transform in bit-reversed order. Pointwise product doesn't care
+     *  about order and inverse transform takes it back, so no permutation is done at all
+     */
+    void ntt_forward(limb *values, size_t size, const ntt_prime &prime, const limb *roots) noexcept {
+        size_t block = std::min(size, ntt_block);
+        for (size_t half = size / 2; half >= block; half /= 2) {
+            ntt_forward_stage(values, size, half, prime, roots);
+        }
+        for (size_t offset = 0; offset < size; offset += block) {
+            for (size_t half = block / 2; half > 0; half /= 2) {
+                ntt_forward_stage(values + offset, block, half, prime, roots);
+            }
+        }
+    }
+
+    /** Decimation in time from bit-reversed order with inverse roots, result isn't scaled by 1 / size
+     */
+    void ntt_inverse(limb *values, size_t size, const ntt_prime &prime, const limb *roots) noexcept {
+        size_t block = std::min(size, ntt_block);
+        for (size_t offset = 0; offset < size; offset += block) {
+            for (size_t half = 1; half < block; half *= 2) {
+                ntt_inverse_stage(values + offset, block, half, prime, roots);
+            }
+        }
+        for (size_t half = block; half < size; half *= 2) {
+            ntt_inverse_stage(values, size, half, prime, roots);
+        }
+    }
+
+    /** Cyclic convolution of limbs of a and b modulo prime, result[i] is Montgomery form of length * coefficient
+     */
+    void convolution_modulo(const limb *a, size_t a_size, const limb *b, size_t b_size, bool square, size_t length,
+                            const ntt_prime &prime, limb *result, limb *scratch, limb *roots) noexcept {
+        // limbs may exceed p, conversion to Montgomery form reduces them
+        auto load = [length, &prime](const limb *digits, size_t size, limb *values) {
+            for (size_t i = 0; i < size; ++i) {
+                values[i] = prime.to_montgomery(digits[i]);
+            }
+            std::fill(values + size, values + length, 0);
+        };
+
+        ntt_roots(roots, length, prime, false);
+
+        load(a, a_size, result);
+        ntt_forward(result, length, prime, roots);
+
+        if (square) {
+            for (size_t i = 0; i < length; ++i) {
+                result[i] = prime.multiply(result[i], result[i]);
+            }
+        } else {
+            load(b, b_size, scratch);
+            ntt_forward(scratch, length, prime, roots);
+            for (size_t i = 0; i < length; ++i) {
+                result[i] = prime.multiply(result[i], scratch[i]);
+            }
+        }
+
+        ntt_roots(roots, length, prime, true);
+        ntt_inverse(result, length, prime, roots);
+    }
+
+    /** result (a_size + b_size limbs) = a * b, convolutions modulo three primes are combined by Garner's CRT
+     */
+    void multiply_ntt_kernel(const limb *a, size_t a_size, const limb *b, size_t b_size, limb *result,
+                             const pp_allocator<unsigned int> &allocator) {
+        size_t length = std::bit_ceil(a_size + b_size - 1);
+        bool square = a == b && a_size == b_size;
+
+        std::array<digits_vector, 3> residues{digits_vector(length, 0, allocator), digits_vector(length, 0, allocator),
+                                              digits_vector(length, 0, allocator)};
+        digits_vector scratch(square ? 0 : length, 0, allocator);
+        digits_vector roots(length, 0, allocator);
+
+        for (size_t k = 0; k < ntt_primes.size(); ++k) {
+            convolution_modulo(a, a_size, b, b_size, square, length, ntt_primes[k], residues[k].data(), scratch.data(),
+                               roots.data());
+        }
+
+        const ntt_prime &q1 = ntt_primes[0], &q2 = ntt_primes[1], &q3 = ntt_primes[2];
+
+        // Montgomery multiplication by Montgomery form of constant is plain modular multiplication by it,
+        // and by plain 1 / length it also takes residue out of Montgomery form
+        std::array<limb, 3> scales{};
+        for (size_t k = 0; k < ntt_primes.size(); ++k) {
+            scales[k] = ntt_primes[k].p - (ntt_primes[k].p - 1) / static_cast<limb>(length);
+        }
+        const limb p1_mod_p3 = q3.to_montgomery(q1.p);
+        const limb p1_inverse_mod_p2 = q2.power(q2.to_montgomery(q1.p), q2.p - 2);
+        const limb p12_inverse_mod_p3 = q3.power(q3.to_montgomery(q3.multiply(p1_mod_p3, q2.p)), q3.p - 2);
+
+        // coefficients overlap, so they are summed into 128-bit accumulator that is emitted by limbs
+        const double_limb p1 = q1.p, p2 = q2.p;
+        double_limb accumulator_low = 0, accumulator_high = 0;
+
+        for (size_t i = 0; i < a_size + b_size; ++i) {
+            if (i + 1 < a_size + b_size) {
+                limb r1 = q1.multiply(residues[0][i], scales[0]);
+                limb r2 = q2.multiply(residues[1][i], scales[1]);
+                limb r3 = q3.multiply(residues[2][i], scales[2]);
+
+                // r1 < p1 < p2 and x12 < p3, so differences are brought to non-negative by one modulus
+                limb t1 = q2.multiply(r2 + q2.p - r1, p1_inverse_mod_p2);
+                limb x12_mod_p3 = q3.add(q3.multiply(t1, p1_mod_p3), r1);
+                limb t2 = q3.multiply(r3 + q3.p - x12_mod_p3, p12_inverse_mod_p3);
+
+                // x = r1 + p1 * (t1 + p2 * t2) < 2^91
+                double_limb inner = t1 + p2 * t2;
+                double_limb low_product = p1 * (inner & 0xFFFFFFFFu);
+                double_limb high_product = p1 * (inner >> limb_bits);
+
+                double_limb x_low = low_product + (high_product << limb_bits);
+                double_limb x_high = (high_product >> limb_bits) + (x_low < low_product);
+                double_limb sum = x_low + r1;
+                x_high += sum < x_low;
+                x_low = sum;
+
+                accumulator_low += x_low;
+                accumulator_high += x_high + (accumulator_low < x_low);
+            }
+
+            result[i] = static_cast<limb>(accumulator_low);
+            accumulator_low = (accumulator_low >> limb_bits) | (accumulator_high << limb_bits);
+            accumulator_high >>= limb_bits;
+        }
+    }
+
+    // reciprocal of this many limbs or less is one division, Newton steps double precision above it.
+    // It doesn't follow newton_division, which only decides when Newton division is chosen
+    constexpr size_t reciprocal_base = 4 * std::min<size_t>(big_int_thresholds::burnikel_ziegler_division, 256);
+
+    // below this many limbs gcd is computed by Lehmer steps alone, half-gcd recursion costs several
+    // multiplications per level and pays off only for longer operands
+    constexpr size_t half_gcd_threshold = 24000;
+
+    double_limb binary_gcd(double_limb a, double_limb b) noexcept {
+        if (a == 0) return b;
+        if (b == 0) return a;
+
+        int shift = std::countr_zero(a | b);
+        a >>= std::countr_zero(a);
+        do {
+            b >>= std::countr_zero(b);
+            if (a > b) {
+                std::swap(a, b);
+            }
+            b -= a;
+        } while (b != 0);
+
+        return a << shift;
+    }
+
+    /** (u, v) -> (a u + b v, c u + d v) replaces several Euclid steps, coefficients are below 2^30 in absolute value
+     */
+    struct lehmer_cofactors {
+        long long a, b, c, d;
+    };
+
+    constexpr long long lehmer_cofactor_limit = 1LL << 30;
+
+    // 62 bits of a starting at bit shift
+    long long leading_bits(const limb *a, size_t size, size_t shift) noexcept {
+        size_t index = shift / limb_bits, offset = shift % limb_bits;
+        auto at = [a, size](size_t i) { return i < size ? static_cast<double_limb>(a[i]) : 0; };
+
+        double_limb result = (at(index) | at(index + 1) << limb_bits) >> offset;
+        if (offset != 0) {
+            result |= at(index + 2) << (2 * limb_bits - offset);
+        }
+        return static_cast<long long>(result & ((1ULL << 62) - 1));
+    }
+
+    /** Knuth's algorithm L: Euclid steps simulated on 62 leading bits while both bounds agree on quotient.
+     *  Returns false if not even one quotient is known, then ordinary division step is needed
+     */
+    bool compute_lehmer_cofactors(const limb *u, size_t u_size, const limb *v, size_t v_size, lehmer_cofactors &result) noexcept {
+        size_t bits = u_size * limb_bits - std::countl_zero(u[u_size - 1]);
+        size_t shift = bits > 62 ? bits - 62 : 0;
+
+        long long x = leading_bits(u, u_size, shift), y = leading_bits(v, v_size, shift);
+        long long a = 1, b = 0, c = 0, d = 1;
+
+        while (y + c > 0 && y + d > 0) {
+            long long q = (x + a) / (y + c);
+            if (q != (x + b) / (y + d)) {
+                break;
+            }
+
+            long long next_c = a - q * c, next_d = b - q * d;
+            if (next_c >= lehmer_cofactor_limit || next_c <= -lehmer_cofactor_limit ||
+                next_d >= lehmer_cofactor_limit || next_d <= -lehmer_cofactor_limit) {
+                break;
+            }
+
+            a = c;
+            c = next_c;
+            b = d;
+            d = next_d;
+
+            long long next_y = x - q * y;
+            x = y;
+            y = next_y;
+        }
+
+        result = {a, b, c, d};
+        return b != 0;
+    }
+
+    // (x, y) = (a x + b y, c x + d y) for magnitudes of size limbs, carries out of the top limbs are dropped
+    void combine_magnitudes(limb *x, limb *y, size_t size, double_limb a, double_limb b, double_limb c, double_limb d) noexcept {
+        double_limb carry_x = 0, carry_y = 0;
+        for (size_t i = 0; i < size; ++i) {
+            carry_x += a * x[i] + b * y[i];
+            carry_y += c * x[i] + d * y[i];
+            x[i] = static_cast<limb>(carry_x);
+            y[i] = static_cast<limb>(carry_y);
+            carry_x >>= limb_bits;
+            carry_y >>= limb_bits;
+        }
     }
 
+    // (u, v) = (a u + b v, c u + d v) for u and v of size limbs, results are known to be nonnegative
+    void apply_lehmer_cofactors(limb *u, limb *v, size_t size, const lehmer_cofactors &cofactors) noexcept {
+        long long carry_u = 0, carry_v = 0;
+        for (size_t i = 0; i < size; ++i) {
+            auto u_i = static_cast<long long>(u[i]), v_i = static_cast<long long>(v[i]);
+            carry_u += cofactors.a * u_i + cofactors.b * v_i;
+            carry_v += cofactors.c * u_i + cofactors.d * v_i;
+            u[i] = static_cast<limb>(carry_u);
+            v[i] = static_cast<limb>(carry_v);
+            carry_u >>= limb_bits;
+            carry_v >>= limb_bits;
+        }
+    }
+
+    // largest power of radix that fits into limb and its exponent
+    std::pair<limb, size_t> conversion_chunk(unsigned int radix) noexcept {
+        double_limb chunk = radix;
+        size_t digits = 1;
+        while (chunk * radix <= std::numeric_limits<limb>::max()) {
+            chunk *= radix;
+            ++digits;
+        }
+        return {static_cast<limb>(chunk), digits};
+    }
+
+    void check_radix(unsigned int radix) {
+        if (radix < 2 || radix > 36) {
+            throw std::invalid_argument("Radix must be in [2, 36]");
+        }
+    }
+
+    unsigned int digit_value(char c, unsigned int radix) {
+        unsigned int value = 36;
+        if (c >= '0' && c <= '9') {
+            value = c - '0';
+        } else if (c >= 'a' && c <= 'z') {
+            value = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'Z') {
+            value = c - 'A' + 10;
+        }
+
+        if (value >= radix) {
+            throw std::invalid_argument("Invalid character in number string");
+        }
+        return value;
+    }
+
+#ifdef MP_OS_BIG_INT_WIDE_KERNELS
+    using montgomery_word = word;
+    using montgomery_double = double_word;
+#else
+    using montgomery_word = limb;
+    using montgomery_double = double_limb;
+#endif
+
+    constexpr size_t montgomery_word_bits = 8 * sizeof(montgomery_word);
+    constexpr size_t limbs_per_word = sizeof(montgomery_word) / sizeof(limb);
+
+    // limbs packed into count words, least significant first
+    void pack_words(const limb *limbs, size_t size, montgomery_word *words, size_t count) noexcept {
+        std::fill(words, words + count, 0);
+        for (size_t i = 0; i < size; ++i) {
+            words[i / limbs_per_word] |= static_cast<montgomery_word>(limbs[i]) << (limb_bits * (i % limbs_per_word));
+        }
+    }
+
+    void unpack_words(const montgomery_word *words, size_t count, limb *limbs) noexcept {
+        for (size_t i = 0; i < count * limbs_per_word; ++i) {
+            limbs[i] = static_cast<limb>(words[i / limbs_per_word] >> (limb_bits * (i % limbs_per_word)));
+        }
+    }
+
+    /** result = a * b * R^-1 mod m for a, b < m of n words, reduction is interleaved with product rows (CIOS).
+     *  t is scratch of n + 2 words, result may alias a or b. Final subtraction is selected by mask, so the
+     *  sequence of operations doesn't depend on values
+     */
+    void montgomery_multiply(const montgomery_word *a, const montgomery_word *b, const montgomery_word *m, size_t n,
+                             montgomery_word inverse, montgomery_word *t, montgomery_word *result) noexcept {
+        std::fill(t, t + n + 2, 0);
+        for (size_t i = 0; i < n; ++i) {
+            montgomery_word a_i = a[i];
+            montgomery_double carry = 0;
+            for (size_t j = 0; j < n; ++j) {
+                carry += static_cast<montgomery_double>(a_i) * b[j] + t[j];
+                t[j] = static_cast<montgomery_word>(carry);
+                carry >>= montgomery_word_bits;
+            }
+            carry += t[n];
+            t[n] = static_cast<montgomery_word>(carry);
+            t[n + 1] = static_cast<montgomery_word>(carry >> montgomery_word_bits);
+
+            // u makes t divisible by the word base, t is shifted down by one word on the way
+            montgomery_word u = t[0] * inverse;
+            carry = (static_cast<montgomery_double>(u) * m[0] + t[0]) >> montgomery_word_bits;
+            for (size_t j = 1; j < n; ++j) {
+                carry += static_cast<montgomery_double>(u) * m[j] + t[j];
+                t[j - 1] = static_cast<montgomery_word>(carry);
+                carry >>= montgomery_word_bits;
+            }
+            carry += t[n];
+            t[n - 1] = static_cast<montgomery_word>(carry);
+            t[n] = t[n + 1] + static_cast<montgomery_word>(carry >> montgomery_word_bits);
+        }
+
+        // t < 2m, t - m is kept unless it borrows out of t[n]
+        montgomery_word borrow = 0;
+        for (size_t j = 0; j < n; ++j) {
+            montgomery_double difference = static_cast<montgomery_double>(t[j]) - m[j] - borrow;
+            result[j] = static_cast<montgomery_word>(difference);
+            borrow = static_cast<montgomery_word>(difference >> (2 * montgomery_word_bits - 1));
+        }
+        montgomery_word keep_t = static_cast<montgomery_word>(0) - (borrow & (t[n] ^ 1));
+        for (size_t j = 0; j < n; ++j) {
+            result[j] = (t[j] & keep_t) | (result[j] & ~keep_t);
+        }
+    }
+
+    // all ones if a == b, branch-free
+    montgomery_word equal_mask(montgomery_word a, montgomery_word b) noexcept {
+        montgomery_word difference = a ^ b;
+        return ((difference | (static_cast<montgomery_word>(0) - difference)) >> (montgomery_word_bits - 1)) - 1;
+    }
+
+    size_t window_bits(size_t exponent_bits) noexcept {
+        return exponent_bits > 671 ? 6 : exponent_bits > 239 ? 5 : exponent_bits > 79 ? 4 : exponent_bits > 23 ? 3 : exponent_bits > 7 ? 2 : 1;
+    }
+
+    bool exponent_bit(const limb *exponent, size_t index) noexcept {
+        return (exponent[index / limb_bits] >> (index % limb_bits)) & 1;
+    }
+
+    /** Left-to-right sliding window over exponent of bits > 0: first window loads odd power 2 * index + 1
+     *  of base into accumulator by load(index), then every bit is square() and every window ends with
+     *  multiply(index)
+     */
+    template<class Load, class Square, class Multiply>
+    void sliding_window(const limb *exponent, size_t bits, size_t window, Load load, Square square, Multiply multiply) {
+        bool started = false;
+        size_t i = bits;
+        while (i > 0) {
+            if (!exponent_bit(exponent, i - 1)) {
+                square();
+                --i;
+                continue;
+            }
+
+            // window [low, i) starts and ends with one
+            size_t low = i > window ? i - window : 0;
+            while (!exponent_bit(exponent, low)) {
+                ++low;
+            }
+            size_t value = 0;
+            for (size_t j = i; j-- > low;) {
+                value = 2 * value + exponent_bit(exponent, j);
+            }
+
+            if (started) {
+                for (size_t j = low; j < i; ++j) {
+                    square();
+                }
+                multiply(value / 2);
+            } else {
+                load(value / 2);
+                started = true;
+            }
+            i = low;
+        }
+    }
+}
+
+std::string big_int::to_string(unsigned int radix) const {
+    check_radix(radix);
+    if (is_zero(_digits)) return "0";
+
+    std::string res;
     if (!_sign) {
         res += '-';
     }
 
-    std::reverse(res.begin(), res.end());
+    if (std::has_single_bit(radix)) {
+        // every digit is a bit field, no division needed
+        size_t bits = std::countr_zero(radix);
+        size_t total_bits = _digits.size() * limb_bits - std::countl_zero(_digits.back());
+        for (size_t digit = (total_bits + bits - 1) / bits; digit-- > 0;) {
+            size_t position = digit * bits;
+            double_limb window = _digits[position / limb_bits];
+            if (position / limb_bits + 1 < _digits.size()) {
+                window |= static_cast<double_limb>(_digits[position / limb_bits + 1]) << limb_bits;
+            }
+            res += digit_chars[(window >> (position % limb_bits)) & (radix - 1)];
+        }
+        return res;
+    }
+
+    auto [chunk, chunk_digits] = conversion_chunk(radix);
+    auto powers = conversion_powers(chunk, _digits.size(), _digits.get_allocator());
+    append_digits(res, *this, powers, powers.size(), radix, chunk_digits, 0);
     return res;
 }
 
+std::vector<big_int> big_int::conversion_powers(unsigned int chunk, size_t limbs, pp_allocator<unsigned int> allocator) {
+    std::vector<big_int> powers;
+    powers.emplace_back(chunk, allocator);
+    while (powers.back()._digits.size() * 2 - 1 <= limbs) {
+        powers.push_back(powers.back() * powers.back());
+    }
+    return powers;
+}
+
+void big_int::append_digits(std::string &out, const big_int &value, const std::vector<big_int> &powers, size_t level,
+                            unsigned int radix, size_t chunk_digits, size_t width) {
+    if (level == 0 || value._digits.size() <= conversion_threshold) {
+        digits_vector rest(value._digits);
+        size_t size = rest.size();
+        std::string digits;
+
+        // digits are collected from the least significant one
+        while (size > 1 || rest[0] != 0) {
+            limb part = divide_by_limb(rest.data(), size, powers[0]._digits[0]);
+            while (size > 1 && rest[size - 1] == 0) --size;
+
+            bool is_last = size == 1 && rest[0] == 0;
+            for (size_t i = 0; i < chunk_digits && (!is_last || part != 0); ++i) {
+                digits += digit_chars[part % radix];
+                part /= radix;
+            }
+        }
+        if (digits.empty()) {
+            digits += '0';
+        }
+
+        if (width > digits.size()) {
+            out.append(width - digits.size(), '0');
+        }
+        out.append(digits.rbegin(), digits.rend());
+        return;
+    }
+
+    const big_int &power = powers[level - 1];
+    if (compare_magnitudes(value._digits.data(), value._digits.size(), power._digits.data(), power._digits.size()) < 0) {
+        append_digits(out, value, powers, level - 1, radix, chunk_digits, width);
+        return;
+    }
+
+    big_int high(value._digits.get_allocator()), low(value._digits.get_allocator());
+    divide_magnitudes(value, power, &high, &low, value.decide_div(power._digits.size()));
+
+    size_t low_width = chunk_digits << (level - 1);
+    append_digits(out, high, powers, level - 1, radix, chunk_digits, width > low_width ? width - low_width : 0);
+    append_digits(out, low, powers, level - 1, radix, chunk_digits, low_width);
+}
+
+big_int big_int::from_chunks(const unsigned int *chunks, size_t count, const std::vector<big_int> &powers,
+                             pp_allocator<unsigned int> allocator) {
+    if (count <= conversion_threshold) {
+        digits_vector digits(1, 0, allocator);
+        for (size_t i = count; i-- > 0;) {
+            limb carry = multiply_by_limb_add(digits.data(), digits.size(), powers[0]._digits[0], chunks[i]);
+            if (carry != 0) {
+                digits.push_back(carry);
+            }
+        }
+        return big_int(std::move(digits));
+    }
+
+    // low half has 2^level chunks, so it is multiplied by powers[level]
+    size_t level = std::bit_width(count - 1) - 1;
+    size_t low_count = size_t(1) << level;
+
+    big_int result = from_chunks(chunks + low_count, count - low_count, powers, allocator);
+    result *= powers[level];
+    result += from_chunks(chunks, low_count, powers, allocator);
+    return result;
+}
+
 big_int::multiplication_rule big_int::decide_mult(size_t rhs) const noexcept {
-    return rhs > 64 ? big_int::multiplication_rule::Karatsuba : big_int::multiplication_rule::trivial;
+    size_t size = std::min(_digits.size(), rhs);
+
+    if (size < big_int_thresholds::karatsuba_multiplication) {
+        return big_int::multiplication_rule::trivial;
+    }
+    if (size < big_int_thresholds::toom3_multiplication) {
+        return big_int::multiplication_rule::Karatsuba;
+    }
+    if (size < big_int_thresholds::ntt_multiplication) {
+        return big_int::multiplication_rule::Toom3;
+    }
+    return big_int::multiplication_rule::SchonhageStrassen;
 }
 
 big_int::division_rule big_int::decide_div(size_t rhs) const noexcept {
-    return big_int::division_rule::trivial;
+    // schoolbook division costs divisor * quotient limbs, it is enough when either is short
+    size_t quotient = _digits.size() >= rhs ? _digits.size() - rhs + 1 : 0;
+    size_t size = std::min(rhs, quotient);
+
+    if (size < big_int_thresholds::burnikel_ziegler_division) {
+        return big_int::division_rule::trivial;
+    }
+    if (rhs < big_int_thresholds::newton_division) {
+        return big_int::division_rule::BurnikelZiegler;
+    }
+    return big_int::division_rule::Newton;
 }
 
 std::strong_ordering big_int::operator<=>(const big_int &other) const noexcept {
@@ -75,6 +1100,14 @@ big_int::operator bool() const noexcept {
     return !is_zero(_digits);
 }
 
+size_t big_int::bit_length() const noexcept {
+    size_t top = _digits.size();
+    while (top > 0 && _digits[top - 1] == 0) {
+        --top;
+    }
+    return top == 0 ? 0 : (top - 1) * limb_bits + std::bit_width(_digits[top - 1]);
+}
+
 big_int &big_int::operator++() & {
     *this += big_int(1, _digits.get_allocator());
     return *this;
@@ -109,37 +1142,87 @@ big_int &big_int::operator*=(const big_int &other) & {
     return multiply_assign(other, decide_mult((other._digits.size())));
 }
 
-big_int &big_int::operator/=(const big_int &other) & {
-    return divide_assign(other, decide_div(other._digits.size()));
+big_int &big_int::operator/=(const big_int &other) & {
+    return divide_assign(other, decide_div(other._digits.size()));
+}
+
+big_int &big_int::operator%=(const big_int &other) & {
+    return modulo_assign(other, decide_div(other._digits.size()));
+}
+
+big_int big_int::operator+(const big_int &other) const & {
+    big_int tmp = *this;
+    tmp += other;
+    return tmp;
+}
+
+big_int big_int::operator+(const big_int &other) && {
+    *this += other;
+    return std::move(*this);
+}
+
+big_int big_int::operator+(big_int &&other) const & {
+    other += *this;
+    return std::move(other);
+}
+
+big_int big_int::operator+(big_int &&other) && {
+    *this += other;
+    return std::move(*this);
+}
+
+big_int big_int::operator-(const big_int &other) const & {
+    big_int tmp = *this;
+    tmp -= other;
+    return tmp;
+}
+
+big_int big_int::operator-(const big_int &other) && {
+    *this -= other;
+    return std::move(*this);
+}
+
+big_int big_int::operator-(big_int &&other) const & {
+    // this - other = -(other - this)
+    other -= *this;
+    other._sign = !other._sign || is_zero(other._digits);
+    return std::move(other);
+}
+
+big_int big_int::operator-(big_int &&other) && {
+    *this -= other;
+    return std::move(*this);
 }
 
-big_int &big_int::operator%=(const big_int &other) & {
-    return modulo_assign(other, decide_div(other._digits.size()));
+big_int big_int::operator*(const big_int &other) const & {
+    return multiply(*this, other, decide_mult(other._digits.size()));
 }
 
-big_int big_int::operator+(const big_int &other) const {
-    big_int tmp = *this;
-    return tmp += other;
+big_int big_int::operator*(const big_int &other) && {
+    *this *= other;
+    return std::move(*this);
 }
 
-big_int big_int::operator-(const big_int &other) const {
+big_int big_int::operator/(const big_int &other) const & {
     big_int tmp = *this;
-    return tmp -= other;
+    tmp /= other;
+    return tmp;
 }
 
-big_int big_int::operator*(const big_int &other) const {
-    big_int tmp = *this;
-    return tmp *= other;
+big_int big_int::operator/(const big_int &other) && {
+    *this /= other;
+    return std::move(*this);
 }
 
-big_int big_int::operator/(const big_int &other) const {
+big_int big_int::operator%(const big_int &other) const & {
     big_int tmp = *this;
-    return tmp /= other;
+    tmp %= other;
+    return tmp;
 }
 
-big_int big_int::operator%(const big_int &other) const {
-    big_int tmp = *this;
-    return tmp %= other;
+big_int big_int::operator%(const big_int &other) && {
+    *this %= other;
+    return std::move(*this);
 }
 
 big_int big_int::operator~() const {
@@ -215,20 +1298,15 @@ big_int &big_int::operator<<=(size_t shift) & {
         return *this;
     }
 
-    size_t full_shift = shift / BASE;
-    size_t bit_shift = shift % BASE;
+    size_t full_shift = shift / limb_bits;
+    size_t bit_shift = shift % limb_bits;
 
     if (full_shift > 0) {
         _digits.insert(_digits.begin(), full_shift, 0);
     }
 
     if (bit_shift > 0) {
-        uint32_t carry = 0;
-        for (size_t i = 0; i < _digits.size(); ++i) {
-            uint64_t current = (static_cast<uint64_t>(_digits[i]) << bit_shift) | carry;
-            _digits[i] = static_cast<uint32_t>(current & BASE);
-            carry = static_cast<uint32_t>(current >> BASE);
-        }
+        limb carry = shift_left_in_place(_digits.data() + full_shift, _digits.size() - full_shift, bit_shift);
         if (carry != 0) {
             _digits.push_back(carry);
         }
@@ -243,8 +1321,8 @@ big_int &big_int::operator>>=(size_t shift) & {
         return *this;
     }
 
-    size_t full_shift = shift / BASE;
-    size_t bit_shift = shift % BASE;
+    size_t full_shift = shift / limb_bits;
+    size_t bit_shift = shift % limb_bits;
 
     if (full_shift >= _digits.size()) {
         _digits = {0};
@@ -255,12 +1333,7 @@ big_int &big_int::operator>>=(size_t shift) & {
     _digits.erase(_digits.begin(), _digits.begin() + static_cast<std::vector<unsigned int>::difference_type>(full_shift));
 
     if (bit_shift > 0) {
-        uint32_t carry = 0;
-        for (size_t i = _digits.size(); i-- > 0;) {
-            uint64_t current = (static_cast<uint64_t>(carry) << BASE) | _digits[i];
-            _digits[i] = static_cast<uint32_t>(current >> bit_shift);
-            carry = static_cast<uint32_t>(current & ((1ULL << bit_shift) - 1));
-        }
+        shift_right_in_place(_digits.data(), _digits.size(), bit_shift);
     }
 
     optimise(_digits);
@@ -284,63 +1357,94 @@ std::istream &operator>>(std::istream &stream, big_int &value) {
 }
 
 
-big_int::big_int(const std::vector<unsigned int, pp_allocator<unsigned int>> &digits, bool sign) : _digits(digits), _sign(sign) {
+big_int::big_int(const std::vector<unsigned int, pp_allocator<unsigned int>> &digits, bool sign) : _sign(sign), _digits(digits) {
     if (_digits.empty()) {
         _digits.push_back(0);
     }
     optimise(_digits);
 }
 
-big_int::big_int(std::vector<unsigned int, pp_allocator<unsigned int>> &&digits, bool sign) noexcept : _digits(std::move(digits)), _sign(sign) {
+big_int::big_int(std::vector<unsigned int, pp_allocator<unsigned int>> &&digits, bool sign) noexcept : _sign(sign), _digits(std::move(digits)) {
     if (_digits.empty()) {
         _digits.push_back(0);
     }
     optimise(_digits);
 }
 
+big_int::big_int(const limb_vector &digits, bool sign) : _sign(sign), _digits(digits) {
+    if (_digits.empty()) {
+        _digits.push_back(0);
+    }
+    optimise(_digits);
+}
 
-big_int::big_int(const std::string &num, unsigned int radix, pp_allocator<unsigned int> allocator) : _sign(true), _digits(allocator) {
-    if (num.empty()) {
+big_int::big_int(limb_vector &&digits, bool sign) noexcept : _sign(sign), _digits(std::move(digits)) {
+    if (_digits.empty()) {
         _digits.push_back(0);
-        return;
     }
+    optimise(_digits);
+}
+
+
+big_int::big_int(const std::string &num, unsigned int radix, pp_allocator<unsigned int> allocator) : _sign(true), _digits(allocator) {
+    check_radix(radix);
 
-    std::string num1 = num;
+    size_t begin = 0;
     bool is_neg = false;
-    if (num1[0] == '-') {
-        is_neg = true;
-        num1 = num1.substr(1);
-    } else if (num1[0] == '+') {
-        num1 = num1.substr(1);
+    if (!num.empty() && (num[0] == '-' || num[0] == '+')) {
+        is_neg = num[0] == '-';
+        ++begin;
     }
 
-    while (num1.size() > 1 && num1[0] == '0') {
-        num1 = num1.substr(1);
+    while (begin + 1 < num.size() && num[begin] == '0') {
+        ++begin;
     }
 
-    if (num1.empty()) {
+    size_t length = num.size() - begin;
+    if (length == 0) {
         _digits.push_back(0);
         return;
     }
 
-    _digits.push_back(0);
-    for (char c: num1) {
-        if (!std::isdigit(c)) {
-            throw std::invalid_argument("Invalid character in number string");
+    if (std::has_single_bit(radix)) {
+        size_t bits = std::countr_zero(radix);
+        _digits.assign((length * bits + limb_bits - 1) / limb_bits, 0);
+
+        for (size_t i = 0; i < length; ++i) {
+            double_limb value = digit_value(num[num.size() - 1 - i], radix);
+            size_t position = i * bits;
+            _digits[position / limb_bits] |= static_cast<limb>(value << (position % limb_bits));
+            if (position % limb_bits + bits > limb_bits) {
+                _digits[position / limb_bits + 1] |= static_cast<limb>(value >> (limb_bits - position % limb_bits));
+            }
+        }
+    } else {
+        auto [chunk, chunk_digits] = conversion_chunk(radix);
+
+        // chunks[0] is the least significant one
+        std::vector<limb> chunks((length + chunk_digits - 1) / chunk_digits, 0);
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            size_t end = num.size() - i * chunk_digits;
+            size_t start = end - std::min(chunk_digits, end - begin);
+            for (size_t j = start; j < end; ++j) {
+                chunks[i] = chunks[i] * radix + digit_value(num[j], radix);
+            }
         }
 
-        unsigned int digit = c - '0';
-        *this *= 10;
-        *this += big_int(static_cast<long long>(digit), allocator);
-    }
+        std::vector<big_int> powers;
+        powers.emplace_back(chunk, allocator);
+        while ((size_t(2) << (powers.size() - 1)) < chunks.size() && chunks.size() > conversion_threshold) {
+            powers.push_back(powers.back() * powers.back());
+        }
 
-    _sign = !is_neg;
-    if (is_zero(_digits)) {
-        _sign = true;
+        _digits = std::move(from_chunks(chunks.data(), chunks.size(), powers, allocator)._digits);
     }
+
+    optimise(_digits);
+    _sign = !is_neg || is_zero(_digits);
 }
 
-big_int::big_int(pp_allocator<unsigned int> allocator) : _digits(allocator), _sign(true) {
+big_int::big_int(pp_allocator<unsigned int> allocator) : _sign(true), _digits(allocator) {
     _digits.push_back(0);
 }
 
@@ -349,302 +1453,787 @@ big_int &big_int::plus_assign(const big_int &other, size_t shift) & {
     if (is_zero(other._digits)) return *this;
 
     if (_sign == other._sign) {
-        size_t max_size = std::max(_digits.size(), other._digits.size() + shift);
-        _digits.resize(max_size, 0);
-
-        uint32_t carry = 0;
-        for (size_t i = 0; i < max_size; ++i) {
-            uint32_t a = (i < _digits.size()) ? _digits[i] : 0;
-            uint32_t b = (i >= shift && (i - shift) < other._digits.size()) ? other._digits[i - shift] : 0;
-
-
-            uint16_t a_lo = a & 0xFFFF, a_hi = a >> 16;
-            uint16_t b_lo = b & 0xFFFF, b_hi = b >> 16;
+        add_magnitude(other, shift);
+    } else {
+        subtract_magnitude(other, shift);
+    }
+    return *this;
+}
 
+big_int &big_int::minus_assign(const big_int &other, size_t shift) & {
+    if (is_zero(other._digits)) return *this;
 
-            uint32_t lo = static_cast<uint32_t>(a_lo) + b_lo + (carry & 0xFFFF);
-            carry = lo >> 16;
+    if (_sign != other._sign) {
+        add_magnitude(other, shift);
+    } else {
+        subtract_magnitude(other, shift);
+    }
+    return *this;
+}
 
-            uint32_t hi = static_cast<uint32_t>(a_hi) + b_hi + carry;
-            carry = hi >> 16;
+void big_int::add_magnitude(const big_int &other, size_t shift) {
+    size_t other_size = other._digits.size() + shift;
+    if (_digits.size() < other_size) {
+        _digits.resize(other_size, 0);
+    }
 
-            _digits[i] = (hi << 16) | (lo & 0xFFFF);
-        }
+    limb carry = add_in_place(_digits.data() + shift, _digits.size() - shift, other._digits.data(), other._digits.size());
+    if (carry != 0) {
+        _digits.push_back(carry);
+    }
+}
 
-        if (carry > 0) {
-            _digits.push_back(carry);
-        }
+void big_int::subtract_magnitude(const big_int &other, size_t shift) {
+    // other is shifted by whole limbs, so its low limbs are zero and only the rest of *this takes part
+    size_t other_size = other._digits.size() + shift;
+    bool less = _digits.size() < other_size ||
+                (_digits.size() == other_size &&
+                 compare_magnitudes(_digits.data() + shift, other._digits.size(), other._digits.data(), other._digits.size()) < 0);
+
+    if (less) {
+        digits_vector result(other_size, 0, _digits.get_allocator());
+        std::copy(other._digits.begin(), other._digits.end(), result.begin() + static_cast<std::ptrdiff_t>(shift));
+        subtract_in_place(result.data(), other_size, _digits.data(), _digits.size());
+        _digits = std::move(result);
+        _sign = !_sign;
     } else {
-        big_int temp(other);
-        temp._sign = _sign;
-        minus_assign(temp, shift);
+        subtract_in_place(_digits.data() + shift, _digits.size() - shift, other._digits.data(), other._digits.size());
     }
 
     optimise(_digits);
-    if (is_zero(_digits)) _sign = true;
+    if (is_zero(_digits)) {
+        _sign = true;
+    }
+}
 
-    return *this;
+big_int &big_int::addmul(const big_int &a, const big_int &b) & {
+    return multiply_accumulate(a, b, false);
 }
 
-big_int &big_int::minus_assign(const big_int &other, size_t shift) & {
-    if (is_zero(other._digits)) return *this;
+big_int &big_int::submul(const big_int &a, const big_int &b) & {
+    return multiply_accumulate(a, b, true);
+}
 
-    if (_sign != other._sign) {
-        big_int temp(other);
-        temp._sign = _sign;
-        return plus_assign(temp, shift);
+big_int &big_int::multiply_accumulate(const big_int &a, const big_int &b, bool subtract) & {
+    if (is_zero(a._digits) || is_zero(b._digits)) return *this;
+
+    bool product_sign = (a._sign == b._sign) != subtract;
+    const big_int &longer = a._digits.size() >= b._digits.size() ? a : b;
+    const big_int &shorter = a._digits.size() >= b._digits.size() ? b : a;
+
+    // magnitudes add only when signs agree, subquadratic products and aliasing need the product on its own
+    bool fused = (product_sign == _sign || is_zero(_digits)) &&
+                 shorter._digits.size() < big_int_thresholds::karatsuba_multiplication &&
+                 this != &a && this != &b;
+    if (!fused) {
+        big_int product = multiply(a, b, decide_mult(shorter._digits.size()));
+        return subtract ? minus_assign(product) : plus_assign(product);
     }
 
-    big_int abs_this(*this);
-    abs_this._sign = true;
-    big_int abs_other(other);
-    abs_other._sign = true;
-    abs_other <<= shift;
+    size_t size = std::max(_digits.size(), a._digits.size() + b._digits.size()) + 1;
+    _digits.resize(size, 0);
+    multiply_add(_digits.data(), size, longer._digits.data(), longer._digits.size(),
+                 shorter._digits.data(), shorter._digits.size());
+    _sign = product_sign;
+    optimise(_digits);
+    return *this;
+}
+
+big_int &big_int::multiply_assign(const big_int &other, big_int::multiplication_rule rule) & {
+    *this = multiply(*this, other, rule);
+    return *this;
+}
 
-    bool result_sign = _sign;
-    if ((abs_this <=> abs_other) == std::strong_ordering::less) {
-        result_sign = !result_sign;
-        std::swap(abs_this._digits, abs_other._digits);
+big_int big_int::multiply(const big_int &a, const big_int &b, big_int::multiplication_rule rule) {
+    if (is_zero(a._digits) || is_zero(b._digits)) {
+        return big_int(a._digits.get_allocator());
     }
 
-    size_t max_size = std::max(abs_this._digits.size(), abs_other._digits.size());
-    std::vector<unsigned int, pp_allocator<unsigned int>> result(max_size, 0, _digits.get_allocator());
+    switch (rule) {
+        case multiplication_rule::Karatsuba:
+            return multiply_karatsuba(a, b);
+        case multiplication_rule::Toom3:
+            return multiply_toom3(a, b);
+        case multiplication_rule::SchonhageStrassen:
+            return multiply_ntt(a, b);
+        default: {
+            digits_vector result(a._digits.size() + b._digits.size(), 0, a._digits.get_allocator());
+            multiply_schoolbook(a._digits.data(), a._digits.size(), b._digits.data(), b._digits.size(), result.data());
+            return big_int(std::move(result), a._sign == b._sign);
+        }
+    }
+}
 
-    int32_t borrow = 0;
-    for (size_t i = 0; i < max_size; ++i) {
-        uint32_t a = (i < abs_this._digits.size()) ? abs_this._digits[i] : 0;
-        uint32_t b = (i < abs_other._digits.size()) ? abs_other._digits[i] : 0;
+big_int &big_int::divide_assign(const big_int &other, big_int::division_rule rule) & {
+    if (is_zero(_digits)) return *this;
+    if (is_zero(other._digits)) throw std::logic_error("Division by zero");
 
+    bool sign = _sign == other._sign;
+    divide_magnitudes(*this, other, this, nullptr, rule);
+    _sign = sign || is_zero(_digits);
+    return *this;
+}
 
-        uint16_t a_lo = a & 0xFFFF, a_hi = a >> 16;
-        uint16_t b_lo = b & 0xFFFF, b_hi = b >> 16;
+big_int &big_int::modulo_assign(const big_int &other, big_int::division_rule rule) & {
+    if (is_zero(_digits)) return *this;
+    if (is_zero(other._digits)) throw std::logic_error("Division by zero");
 
+    divide_magnitudes(*this, other, nullptr, this, rule);
+    _sign = true;
+    return *this;
+}
 
-        int32_t lo = static_cast<int32_t>(a_lo) - b_lo - (borrow & 0xFFFF);
-        borrow = 0;
-        if (lo < 0) {
-            lo += 1 << 16;
-            borrow = 1;
+void big_int::divide_magnitudes(const big_int &lhs, const big_int &rhs, big_int *quotient, big_int *remainder,
+                                division_rule rule) {
+    const auto &u = lhs._digits;
+    const auto &v = rhs._digits;
+    auto allocator = u.get_allocator();
+
+    digits_vector q(allocator), r(allocator);
+
+    if (compare_magnitudes(u.data(), u.size(), v.data(), v.size()) < 0) {
+        q.push_back(0);
+        r = u;
+    } else if (v.size() == 1) {
+        q = u;
+        r.push_back(divide_by_limb(q.data(), q.size(), v[0]));
+    } else if (rule == division_rule::trivial) {
+        q.resize(u.size() - v.size() + 1, 0);
+        r.resize(v.size(), 0);
+        divide_knuth(u.data(), u.size(), v.data(), v.size(), q.data(), r.data(), allocator);
+    } else {
+        // divisor is normalized, dividend is cut into chunks of divisor length and processed from the top,
+        // every step divides (remainder * BASE^n + chunk) < divisor * BASE^n
+        size_t shift = std::countl_zero(v.back());
+        big_int divisor(rhs), dividend(lhs);
+        divisor._sign = dividend._sign = true;
+        divisor <<= shift;
+        dividend <<= shift;
+
+        size_t n = divisor._digits.size();
+        size_t chunks = (dividend._digits.size() + n - 1) / n;
+
+        big_int inverse(allocator);
+        if (rule == division_rule::Newton) {
+            inverse = reciprocal(divisor, n);
         }
 
-        int32_t hi = static_cast<int32_t>(a_hi) - b_hi - borrow;
-        borrow = 0;
-        if (hi < 0) {
-            hi += 1 << 16;
-            borrow = 1;
+        q.assign(chunks * n, 0);
+        big_int rest(allocator), part(allocator), part_quotient(allocator);
+
+        for (size_t i = chunks; i-- > 0;) {
+            part = limbs_range(dividend, i * n, (i + 1) * n);
+            part.plus_assign(rest, n);
+
+            if (rule == division_rule::Newton) {
+                // top n + 1 limbs of part times inverse give quotient up to few units
+                part_quotient = limbs_range(limbs_range(part, n - 1, 2 * n) * inverse, n + 1, 3 * n + 2);
+                rest = part - part_quotient * divisor;
+                while (!rest._sign) {
+                    --part_quotient;
+                    rest += divisor;
+                }
+                while (rest >= divisor) {
+                    ++part_quotient;
+                    rest -= divisor;
+                }
+            } else {
+                divide_2n_by_1n(part, divisor, n, part_quotient, rest);
+            }
+
+            std::copy(part_quotient._digits.begin(), part_quotient._digits.end(),
+                      q.begin() + static_cast<long long>(i * n));
         }
 
-        result[i] = (hi << 16) | (lo & 0xFFFF);
+        rest >>= shift;
+        r = std::move(rest._digits);
     }
 
-    _digits = std::move(result);
-    _sign = result_sign;
-    optimise(_digits);
+    optimise(q);
+    optimise(r);
 
-    if (is_zero(_digits)) {
-        _sign = true;
+    if (quotient != nullptr) {
+        quotient->_digits = std::move(q);
+        quotient->_sign = true;
     }
+    if (remainder != nullptr) {
+        remainder->_digits = std::move(r);
+        remainder->_sign = true;
+    }
+}
 
-    return *this;
+big_int big_int::limbs_range(const big_int &value, size_t begin, size_t end) {
+    big_int result(value._digits.get_allocator());
+    end = std::min(end, value._digits.size());
+    if (begin < end) {
+        result._digits.assign(value._digits.begin() + static_cast<long long>(begin),
+                              value._digits.begin() + static_cast<long long>(end));
+        optimise(result._digits);
+    }
+    return result;
 }
 
-big_int &big_int::multiply_assign(const big_int &other, big_int::multiplication_rule rule) & {
-    if (is_zero(_digits) || is_zero(other._digits)) {
-        _digits = {0};
-        _sign = true;
-        return *this;
+void big_int::divide_2n_by_1n(const big_int &a, const big_int &b, size_t n, big_int &quotient, big_int &remainder) {
+    if (n <= big_int_thresholds::burnikel_ziegler_division) {
+        divide_magnitudes(a, b, &quotient, &remainder);
+        return;
     }
 
-    size_t n = _digits.size();
-    size_t m = other._digits.size();
+    // odd n is made even by multiplying both by BASE
+    bool pad = n % 2 != 0;
+    big_int a_padded(a._digits.get_allocator()), b_padded(b._digits.get_allocator());
+    if (pad) {
+        a_padded = a << limb_bits;
+        b_padded = b << limb_bits;
+        ++n;
+    }
+    const big_int &a_even = pad ? a_padded : a;
+    const big_int &b_even = pad ? b_padded : b;
 
-    std::vector<unsigned int, pp_allocator<unsigned int>> result(n + m, 0, _digits.get_allocator());
+    size_t half = n / 2;
+    big_int b1 = limbs_range(b_even, half, n);
+    big_int b2 = limbs_range(b_even, 0, half);
 
-    for (size_t i = 0; i < n; ++i) {
-        uint32_t a = _digits[i];
-        uint16_t a_lo = a & 0xFFFF;
-        uint16_t a_hi = a >> 16;
+    big_int q1(a._digits.get_allocator()), q2(a._digits.get_allocator()), rest(a._digits.get_allocator());
+    divide_3n_by_2n(limbs_range(a_even, n, a_even._digits.size()), limbs_range(a_even, half, n), b_even, b1, b2, half, q1, rest);
+    divide_3n_by_2n(rest, limbs_range(a_even, 0, half), b_even, b1, b2, half, q2, rest);
 
-        uint32_t carry = 0;
-        for (size_t j = 0; j < m || carry; ++j) {
-            uint64_t cur = result[i + j];
-            uint32_t b = (j < m) ? other._digits[j] : 0;
-            uint16_t b_lo = b & 0xFFFF;
-            uint16_t b_hi = b >> 16;
+    if (pad) {
+        rest >>= limb_bits;
+    }
 
-            uint64_t part1 = static_cast<uint64_t>(a_lo) * b_lo;
-            uint64_t part2 = static_cast<uint64_t>(a_lo) * b_hi;
-            uint64_t part3 = static_cast<uint64_t>(a_hi) * b_lo;
-            uint64_t part4 = static_cast<uint64_t>(a_hi) * b_hi;
+    quotient = std::move(q2);
+    quotient.plus_assign(q1, half);
+    remainder = std::move(rest);
+}
 
-            cur += part1 + ((part2 + part3) << 16) + (part4 << 32) + carry;
-            result[i + j] = static_cast<uint32_t>(cur % BASE);
-            carry = static_cast<uint32_t>(cur / BASE);
-        }
+void big_int::divide_3n_by_2n(const big_int &a12, const big_int &a3, const big_int &b, const big_int &b1, const big_int &b2,
+                              size_t n, big_int &quotient, big_int &remainder) {
+    big_int q(a12._digits.get_allocator()), rest(a12._digits.get_allocator());
+
+    if (limbs_range(a12, n, a12._digits.size()) == b1) {
+        // quotient would be BASE^n, it is BASE^n - 1 at most
+        q._digits.assign(n, std::numeric_limits<limb>::max());
+        rest = a12;
+        rest.minus_assign(b1, n);
+        rest += b1;
+    } else {
+        divide_2n_by_1n(a12, b1, n, q, rest);
     }
 
-    _digits = std::move(result);
-    _sign = (_sign == other._sign);
-    optimise(_digits);
-    return *this;
+    big_int shifted = a3;
+    shifted.plus_assign(rest, n);
+    shifted -= q * b2;
+
+    while (!shifted._sign) {
+        --q;
+        shifted += b;
+    }
+
+    quotient = std::move(q);
+    remainder = std::move(shifted);
 }
 
-big_int &big_int::divide_assign(const big_int &other, big_int::division_rule rule) & {
-    if (is_zero(_digits)) return *this;
-    if (is_zero(other._digits)) throw std::logic_error("Division by zero");
+big_int big_int::reciprocal(const big_int &divisor, size_t n) {
+    big_int power(1, divisor._digits.get_allocator());
+    power <<= 2 * n * limb_bits;
 
-    big_int abs_this(*this);
-    abs_this._sign = true;
-    big_int abs_other(other);
-    abs_other._sign = true;
-    if (abs_this < abs_other) {
-        _digits.clear();
-        _digits.push_back(0);
-        _sign = true;
-        return *this;
+    if (n <= reciprocal_base || n <= 2) {
+        return power / divisor;
     }
 
-    std::vector<unsigned int, pp_allocator<unsigned int>> quotient(_digits.size(), 0, _digits.get_allocator());
-    big_int remain(_digits.get_allocator());
-    remain._digits.clear();
-    remain._digits.push_back(0);
-    for (int i = static_cast<int>(_digits.size()) - 1; i >= 0; i--) {
-        remain._digits.insert(remain._digits.begin(), _digits[i]);
-        while (remain._digits.size() > 1 && remain._digits.back() == 0) {
-            remain._digits.pop_back();
-        }
+    // reciprocal of top half is exact to half of limbs, one Newton step x += x * (BASE^2n - d x) / BASE^2n doubles that
+    size_t high = (n + 1) / 2, low = n - high;
+    big_int result = reciprocal(limbs_range(divisor, low, n), high);
+    result <<= low * limb_bits;
 
-        if (remain._digits.empty()) {
-            remain._sign = true;
-        }
+    big_int error = power - divisor * result;
+    bool overestimated = !error._sign;
+    error._sign = true;
 
-        unsigned long long left = 0, q = 0, right = BASE;
-        while (left <= right) {
-            unsigned long long mid = left + (right - left) / 2;
-            big_int temp = abs_other * big_int(static_cast<long long>(mid), _digits.get_allocator());
-            if (remain >= temp) {
-                q = mid;
-                left = mid + 1;
-            } else {
-                right = mid - 1;
+    big_int correction = result * error;
+    correction >>= 2 * n * limb_bits;
+    if (overestimated) {
+        result -= correction;
+    } else {
+        result += correction;
+    }
+
+    big_int rest = power - divisor * result;
+    while (!rest._sign) {
+        --result;
+        rest += divisor;
+    }
+    while (rest >= divisor) {
+        ++result;
+        rest -= divisor;
+    }
+    return result;
+}
+
+void big_int::euclid_step(big_int &a, big_int &b, std::array<big_int, 4> *matrix) {
+    big_int quotient(a._digits.get_allocator()), remainder(a._digits.get_allocator());
+    divide_magnitudes(a, b, &quotient, &remainder, a.decide_div(b._digits.size()));
+
+    a = std::move(b);
+    b = std::move(remainder);
+
+    if (matrix != nullptr) {
+        auto &m = *matrix;
+        std::swap(m[0], m[2]);
+        std::swap(m[1], m[3]);
+        m[2] -= quotient * m[0];
+        m[3] -= quotient * m[1];
+    }
+}
+
+void big_int::lehmer_reduce(big_int &a, big_int &b, size_t target, std::array<big_int, 4> *matrix) {
+    auto &u = a._digits;
+    auto &v = b._digits;
+    auto allocator = u.get_allocator();
+    target = std::max<size_t>(target, 2);
+
+    // matrix of Euclid steps has signs [[+, -], [-, +]] after even number of steps and opposite after odd,
+    // so only magnitudes of its columns are kept, and every step adds them up
+    size_t capacity = matrix != nullptr ? u.size() + 2 : 0, used = 1;
+    digits_vector top_left(capacity, 0, allocator), bottom_left(capacity, 0, allocator);
+    digits_vector top_right(capacity, 0, allocator), bottom_right(capacity, 0, allocator);
+    bool odd = false;
+    if (matrix != nullptr) {
+        top_left[0] = bottom_right[0] = 1;
+    }
+
+    while (v.size() > target) {
+        lehmer_cofactors cofactors{};
+        if (compute_lehmer_cofactors(u.data(), u.size(), v.data(), v.size(), cofactors)) {
+            v.resize(u.size(), 0);
+            apply_lehmer_cofactors(u.data(), v.data(), u.size(), cofactors);
+            optimise(u);
+            optimise(v);
+
+            if (matrix != nullptr) {
+                used = std::min(used + 1, capacity);
+                auto magnitude = [](long long value) { return static_cast<double_limb>(value < 0 ? -value : value); };
+                double_limb ma = magnitude(cofactors.a), mb = magnitude(cofactors.b);
+                double_limb mc = magnitude(cofactors.c), md = magnitude(cofactors.d);
+                combine_magnitudes(top_left.data(), bottom_left.data(), used, ma, mb, mc, md);
+                combine_magnitudes(top_right.data(), bottom_right.data(), used, ma, mb, mc, md);
+                odd ^= cofactors.d < 0;
             }
+            continue;
         }
 
-        if (q > 0) {
-            big_int temp = abs_other * big_int(static_cast<long long>(q), _digits.get_allocator());
-            remain -= temp;
+        // quotient doesn't fit into leading bits
+        big_int quotient(allocator), remainder(allocator);
+        divide_magnitudes(a, b, &quotient, &remainder, a.decide_div(v.size()));
+        a = std::move(b);
+        b = std::move(remainder);
+
+        if (matrix != nullptr) {
+            for (auto column: {std::pair(&top_left, &bottom_left), std::pair(&top_right, &bottom_right)}) {
+                big_int top(*column.first), bottom(*column.second);
+                top.plus_assign(quotient * bottom);
+                column.first->swap(*column.second);
+                std::fill(column.second->begin(), column.second->end(), 0);
+                std::copy(top._digits.begin(), top._digits.end(), column.second->begin());
+                used = std::max(used, top._digits.size());
+            }
+            odd = !odd;
         }
-        quotient[i] = static_cast<unsigned int>(q);
     }
 
-    _sign = (_sign == other._sign);
-    _digits = std::move(quotient);
-    optimise(_digits);
-    return *this;
+    if (matrix != nullptr) {
+        auto entry = [](digits_vector &digits, bool sign) {
+            big_int result(std::move(digits), sign);
+            result._sign = sign || is_zero(result._digits);
+            return result;
+        };
+        *matrix = {entry(top_left, !odd), entry(top_right, odd), entry(bottom_left, odd), entry(bottom_right, !odd)};
+    }
 }
 
-big_int &big_int::modulo_assign(const big_int &other, big_int::division_rule rule) & {
-    if (is_zero(_digits)) return *this;
-    if (is_zero(other._digits)) throw std::logic_error("Division by zero");
+void big_int::compose(const std::array<big_int, 4> &by, std::array<big_int, 4> &matrix) {
+    auto &m = matrix;
+    matrix = {by[0] * m[0] + by[1] * m[2], by[0] * m[1] + by[1] * m[3],
+              by[2] * m[0] + by[3] * m[2], by[2] * m[1] + by[3] * m[3]};
+}
 
-    big_int abs_this(*this);
-    abs_this._sign = true;
-    big_int abs_other(other);
-    abs_other._sign = true;
-    if (abs_this < abs_other) {
-        _sign = true;
-        return *this;
+void big_int::transform(big_int &a, big_int &b, const std::array<big_int, 4> &by, std::array<big_int, 4> *matrix) {
+    big_int first = by[0] * a + by[1] * b;
+    big_int second = by[2] * a + by[3] * b;
+
+    std::array<big_int, 4> product;
+    if (matrix != nullptr) {
+        product = *matrix;
+        compose(by, product);
     }
 
-    big_int remain(_digits.get_allocator());
-    remain._digits.clear();
-    remain._digits.push_back(0);
-    for (int i = static_cast<int>(_digits.size()) - 1; i >= 0; --i) {
-        remain._digits.insert(remain._digits.begin(), _digits[i]);
-        while (remain._digits.size() > 1 && remain._digits.back() == 0) {
-            remain._digits.pop_back();
-        }
+    // reduction of leading limbs may be off by a step for whole numbers, signs and order are restored by
+    // unimodular changes, so the pair still has the same gcd
+    auto negate = [](big_int &value) {
+        value._sign = !value._sign || is_zero(value._digits);
+    };
+    if (!first._sign) {
+        negate(first);
+        negate(product[0]);
+        negate(product[1]);
+    }
+    if (!second._sign) {
+        negate(second);
+        negate(product[2]);
+        negate(product[3]);
+    }
+    if (first < second) {
+        std::swap(first, second);
+        std::swap(product[0], product[2]);
+        std::swap(product[1], product[3]);
+    }
 
-        if (remain._digits.empty()) {
-            remain._sign = true;
-        }
+    a = std::move(first);
+    b = std::move(second);
+    if (matrix != nullptr) {
+        *matrix = std::move(product);
+    }
+}
 
-        unsigned long long left = 0, right = BASE;
-        unsigned long long q = 0;
-        while (left <= right) {
-            unsigned long long mid = left + (right - left) / 2;
-            big_int temp = abs_other * big_int(static_cast<long long>(mid), _digits.get_allocator());
-            if (remain >= temp) {
-                q = mid;
-                left = mid + 1;
-            } else {
-                right = mid - 1;
-            }
-        }
+void big_int::half_gcd(big_int &a, big_int &b, std::array<big_int, 4> *matrix) {
+    auto allocator = a._digits.get_allocator();
+    if (matrix != nullptr) {
+        *matrix = {big_int(1, allocator), big_int(0, allocator), big_int(0, allocator), big_int(1, allocator)};
+    }
 
-        if (q > 0) {
-            big_int temp = abs_other * big_int(static_cast<long long>(q), _digits.get_allocator());
-            remain -= temp;
-        }
+    size_t n = a._digits.size();
+    size_t target = n / 2 + 1;
+    if (b._digits.size() <= target) {
+        return;
     }
 
-    _digits = std::move(remain._digits);
-    _sign = true;
-    optimise(_digits);
-    return *this;
+    if (n < half_gcd_threshold) {
+        lehmer_reduce(a, b, target, matrix);
+        return;
+    }
+
+    // leading half of limbs determines first quarter of quotients
+    std::array<big_int, 4> step;
+    size_t split = n / 2;
+    big_int a_high = limbs_range(a, split, n), b_high = limbs_range(b, split, n);
+    half_gcd(a_high, b_high, &step);
+    transform(a, b, step, matrix);
+
+    if (b._digits.size() > target) {
+        euclid_step(a, b, matrix);
+    }
+
+    // second quarter from leading limbs of current pair of k limbs, split so that b of the reduced top
+    // lands at target limbs of the whole pair
+    size_t k = a._digits.size();
+    if (b._digits.size() > target && 2 * target > k + 2) {
+        split = 2 * target - k - 2;
+        a_high = limbs_range(a, split, k);
+        b_high = limbs_range(b, split, k);
+        half_gcd(a_high, b_high, &step);
+        transform(a, b, step, matrix);
+    }
+
+    // the rest, usually few steps
+    if (b._digits.size() > target) {
+        lehmer_reduce(a, b, target, matrix != nullptr ? &step : nullptr);
+        if (matrix != nullptr) {
+            compose(step, *matrix);
+        }
+    }
 }
 
 big_int multiply_karatsuba(const big_int &a, const big_int &b) {
-    if (a._digits.size() < 32 || b._digits.size() < 32) {
+    const big_int &longer = a._digits.size() >= b._digits.size() ? a : b;
+    const big_int &shorter = a._digits.size() >= b._digits.size() ? b : a;
+
+    size_t a_size = longer._digits.size(), b_size = shorter._digits.size();
+    auto allocator = a._digits.get_allocator();
+
+    // scratch is taken once here, recursion works on its parts only
+    digits_vector scratch(multiply_scratch_size(a_size, b_size), 0, allocator);
+    big_int result(allocator);
+    result._digits.assign(a_size + b_size, 0);
+
+    multiply_spans(longer._digits.data(), a_size, shorter._digits.data(), b_size, result._digits.data(), scratch.data());
+
+    optimise(result._digits);
+    result._sign = a._sign == b._sign || is_zero(result._digits);
+    return result;
+}
+
+big_int multiply_toom3(const big_int &a, const big_int &b) {
+    if (a._digits.size() < 3 || b._digits.size() < 3) {
+        big_int result = a;
+        result.multiply_assign(b, big_int::multiplication_rule::trivial);
+        return result;
+    }
+
+    size_t part_size = (std::max(a._digits.size(), b._digits.size()) + 2) / 3;
+
+    auto part = [part_size](const big_int &value, size_t index) {
+        big_int result(value._digits.get_allocator());
+        size_t begin = std::min(index * part_size, value._digits.size());
+        size_t end = std::min(begin + part_size, value._digits.size());
+        if (begin < end) {
+            result._digits.assign(value._digits.begin() + static_cast<long long>(begin),
+                                  value._digits.begin() + static_cast<long long>(end));
+            optimise(result._digits);
+        }
+        return result;
+    };
+
+    // values of a2 x^2 + a1 x + a0 at 0, 1, -1, -2 and infinity
+    auto evaluate = [&part](const big_int &value) {
+        big_int v0 = part(value, 0), v1 = part(value, 1), v2 = part(value, 2);
+        big_int p = v0 + v2;
+        big_int at_one = p + v1;
+        big_int at_minus_one = p - v1;
+        big_int at_minus_two = ((at_minus_one + v2) << 1) - v0;
+        return std::array<big_int, 5>{std::move(v0), std::move(at_one), std::move(at_minus_one), std::move(at_minus_two), std::move(v2)};
+    };
+
+    auto points_a = evaluate(a);
+    auto points_b = evaluate(b);
+
+    big_int r0 = points_a[0] * points_b[0];
+    big_int r1 = points_a[1] * points_b[1];
+    big_int r_minus_1 = points_a[2] * points_b[2];
+    big_int r_minus_2 = points_a[3] * points_b[3];
+    big_int r4 = points_a[4] * points_b[4];
+
+    // interpolation, all divisions are exact
+    big_int r3 = r_minus_2 - r1;
+    r3 /= big_int(3, a._digits.get_allocator());
+    r1 -= r_minus_1;
+    r1 >>= 1;
+    big_int r2 = r_minus_1 - r0;
+    r3 = r2 - r3;
+    r3 >>= 1;
+    r3 += r4 << 1;
+    r2 += r1;
+    r2 -= r4;
+    r1 -= r3;
+
+    big_int result = std::move(r0);
+    result.plus_assign(r1, part_size);
+    result.plus_assign(r2, part_size * 2);
+    result.plus_assign(r3, part_size * 3);
+    result.plus_assign(r4, part_size * 4);
+
+    result._sign = (a._sign == b._sign);
+    optimise(result._digits);
+    return result;
+}
+
+big_int multiply_ntt(const big_int &a, const big_int &b) {
+    size_t a_size = a._digits.size(), b_size = b._digits.size();
+
+    if (a_size < 2 || b_size < 2) {
         big_int result = a;
         result.multiply_assign(b, big_int::multiplication_rule::trivial);
         return result;
     }
 
-    size_t max_size = std::max(a._digits.size(), b._digits.size()) / 2;
+    // too long for the primes, thirds are short enough or split further
+    if (std::bit_ceil(a_size + b_size - 1) > ntt_max_length) {
+        return multiply_toom3(a, b);
+    }
 
-    big_int low1(a._digits.get_allocator()), high1(a._digits.get_allocator());
-    big_int low2(b._digits.get_allocator()), high2(b._digits.get_allocator());
+    big_int result(a._digits.get_allocator());
+    result._digits.assign(a_size + b_size, 0);
+    multiply_ntt_kernel(a._digits.data(), a_size, b._digits.data(), b_size, result._digits.data(), a._digits.get_allocator());
 
-    low1._digits.assign(a._digits.begin(),
-                        a._digits.begin() + static_cast<long long>(std::min(max_size, a._digits.size())));
+    result._sign = (a._sign == b._sign);
+    optimise(result._digits);
+    return result;
+}
 
-    if (a._digits.size() > max_size) {
-        high1._digits.assign(
-                a._digits.begin() + static_cast<long long>(max_size),
-                a._digits.end()
-        );
+big_int gcd(const big_int &a, const big_int &b) {
+    big_int u = a, v = b;
+    u._sign = v._sign = true;
+    if (u < v) {
+        std::swap(u, v);
     }
 
-    low2._digits.assign(b._digits.begin(),
-                        b._digits.begin() + static_cast<long long>(std::min(max_size, b._digits.size())));
+    while (v._digits.size() >= half_gcd_threshold) {
+        big_int::half_gcd(u, v, nullptr);
+        if (is_zero(v._digits)) {
+            return u;
+        }
+        big_int::euclid_step(u, v, nullptr);
+    }
 
-    if (b._digits.size() > max_size) {
-        high2._digits.assign(
-                b._digits.begin() + static_cast<long long>(max_size),
-                b._digits.end()
-        );
+    big_int::lehmer_reduce(u, v, 2, nullptr);
+    if (is_zero(v._digits)) {
+        return u;
     }
 
-    low1._sign = high1._sign = low2._sign = high2._sign = true;
+    // both fit into two limbs after one division
+    big_int::divide_magnitudes(u, v, nullptr, &u);
+    auto to_double_limb = [](const big_int &value) {
+        double_limb result = value._digits[0];
+        if (value._digits.size() > 1) {
+            result |= static_cast<double_limb>(value._digits[1]) << limb_bits;
+        }
+        return result;
+    };
 
-    big_int z0 = multiply_karatsuba(low1, low2);
-    big_int z2 = multiply_karatsuba(high1, high2);
+    double_limb result = binary_gcd(to_double_limb(u), to_double_limb(v));
+    return big_int(result, a._digits.get_allocator());
+}
 
-    big_int sum1 = low1;
-    sum1.plus_assign(high1);
-    big_int sum2 = low2;
-    sum2.plus_assign(high2);
+big_int::montgomery_context::montgomery_context(const big_int &modulus)
+        : _modulus(modulus), _r_squared(modulus._digits.get_allocator()), _inverse(0), _words(0) {
+    if (!modulus._sign || (modulus._digits.size() == 1 && modulus._digits[0] <= 1) || modulus._digits[0] % 2 == 0) {
+        throw std::invalid_argument("Montgomery modulus must be odd and greater than 1");
+    }
 
-    big_int z1 = multiply_karatsuba(sum1, sum2);
-    z1.minus_assign(z0);
-    z1.minus_assign(z2);
+    _words = (modulus._digits.size() + limbs_per_word - 1) / limbs_per_word;
 
-    big_int result = z0;
-    result.plus_assign(z1, max_size * sizeof(unsigned int));
-    result.plus_assign(z2, max_size * 2 * sizeof(unsigned int));
+    big_int r_squared(1, modulus._digits.get_allocator());
+    r_squared <<= 2 * _words * montgomery_word_bits;
+    r_squared %= modulus;
+    _r_squared = std::move(r_squared);
 
-    result._sign = (a._sign == b._sign);
-    optimise(result._digits);
-    return result;
-}
\ No newline at end of file
+    // Newton iteration for m^-1 mod word base doubles correct low bits, m * m = 1 mod 8 gives first three
+    montgomery_word low = 0;
+    pack_words(modulus._digits.data(), std::min(limbs_per_word, modulus._digits.size()), &low, 1);
+    montgomery_word inverse = low;
+    for (size_t bits = 3; bits < montgomery_word_bits; bits *= 2) {
+        inverse *= 2 - low * inverse;
+    }
+    _inverse = static_cast<montgomery_word>(0) - inverse;
+}
+
+const big_int &big_int::montgomery_context::modulus() const noexcept {
+    return _modulus;
+}
+
+big_int big_int::pow_mod(const big_int &exponent, const big_int &modulus, bool constant_time) const {
+    if (!modulus._sign || is_zero(modulus._digits)) {
+        throw std::invalid_argument("Modulus must be positive");
+    }
+    if (!exponent._sign) {
+        throw std::invalid_argument("Exponent must be nonnegative");
+    }
+
+    auto allocator = _digits.get_allocator();
+    if (modulus._digits.size() == 1 && modulus._digits[0] == 1) {
+        return big_int(allocator);
+    }
+    if (modulus._digits[0] % 2 != 0) {
+        return pow_mod(exponent, montgomery_context(modulus), constant_time);
+    }
+    if (constant_time) {
+        throw std::invalid_argument("Constant-time exponentiation needs odd modulus");
+    }
+
+    big_int base = *this % modulus;
+    if (!_sign && !is_zero(base._digits)) {
+        base = modulus - std::move(base);
+    }
+
+    size_t bits = exponent.bit_length();
+    if (bits == 0) {
+        return big_int(1, allocator);
+    }
+
+    size_t window = window_bits(bits);
+    std::vector<big_int> powers(size_t(1) << (window - 1), base);
+    big_int square = base * base % modulus;
+    for (size_t i = 1; i < powers.size(); ++i) {
+        powers[i] = powers[i - 1] * square % modulus;
+    }
+
+    big_int accumulator(allocator);
+    sliding_window(exponent._digits.data(), bits, window,
+                   [&](size_t index) { accumulator = powers[index]; },
+                   [&] { accumulator = accumulator * accumulator % modulus; },
+                   [&](size_t index) { accumulator = accumulator * powers[index] % modulus; });
+    return accumulator;
+}
+
+big_int big_int::pow_mod(const big_int &exponent, const montgomery_context &context, bool constant_time) const {
+    if (!exponent._sign) {
+        throw std::invalid_argument("Exponent must be nonnegative");
+    }
+
+    const big_int &modulus = context._modulus;
+    auto allocator = _digits.get_allocator();
+    size_t n = context._words;
+    auto inverse = static_cast<montgomery_word>(context._inverse);
+
+    big_int base = *this % modulus;
+    if (!_sign && !is_zero(base._digits)) {
+        base = modulus - std::move(base);
+    }
+
+    std::vector<montgomery_word> m(n), r_squared(n), scratch(n + 2), accumulator(n);
+    pack_words(modulus._digits.data(), modulus._digits.size(), m.data(), n);
+    pack_words(context._r_squared._digits.data(), context._r_squared._digits.size(), r_squared.data(), n);
+
+    auto multiply = [&](const montgomery_word *a, const montgomery_word *b, montgomery_word *result) {
+        montgomery_multiply(a, b, m.data(), n, inverse, scratch.data(), result);
+    };
+
+    // base R mod m and R mod m as Montgomery form of 1
+    std::vector<montgomery_word> base_form(n), one(n, 0);
+    pack_words(base._digits.data(), base._digits.size(), base_form.data(), n);
+    multiply(base_form.data(), r_squared.data(), base_form.data());
+    one[0] = 1;
+    multiply(one.data(), r_squared.data(), one.data());
+
+    size_t bits = exponent.bit_length();
+    if (constant_time) {
+        // fixed 4-bit windows over all limbs of exponent, every window multiplies by entry picked by scanning the whole table
+        constexpr size_t window = 4;
+        std::vector<montgomery_word> table((size_t(1) << window) * n), entry(n);
+        std::copy(one.begin(), one.end(), table.begin());
+        for (size_t i = 1; i < (size_t(1) << window); ++i) {
+            multiply(table.data() + (i - 1) * n, base_form.data(), table.data() + i * n);
+        }
+
+        accumulator = one;
+        for (size_t i = exponent._digits.size() * limb_bits; i > 0; i -= window) {
+            for (size_t j = 0; j < window; ++j) {
+                multiply(accumulator.data(), accumulator.data(), accumulator.data());
+            }
+
+            montgomery_word digit = (exponent._digits[(i - window) / limb_bits] >> ((i - window) % limb_bits)) & ((1u << window) - 1);
+            std::fill(entry.begin(), entry.end(), 0);
+            for (size_t k = 0; k < (size_t(1) << window); ++k) {
+                montgomery_word mask = equal_mask(static_cast<montgomery_word>(k), digit);
+                for (size_t j = 0; j < n; ++j) {
+                    entry[j] |= table[k * n + j] & mask;
+                }
+            }
+            multiply(accumulator.data(), entry.data(), accumulator.data());
+        }
+    } else if (bits == 0) {
+        accumulator = one;
+    } else {
+        size_t window = window_bits(bits);
+        std::vector<montgomery_word> powers((size_t(1) << (window - 1)) * n), square(n);
+        std::copy(base_form.begin(), base_form.end(), powers.begin());
+        multiply(base_form.data(), base_form.data(), square.data());
+        for (size_t i = 1; i < powers.size() / n; ++i) {
+            multiply(powers.data() + (i - 1) * n, square.data(), powers.data() + i * n);
+        }
+
+        sliding_window(exponent._digits.data(), bits, window,
+                       [&](size_t index) { std::copy_n(powers.begin() + static_cast<std::ptrdiff_t>(index * n), n, accumulator.begin()); },
+                       [&] { multiply(accumulator.data(), accumulator.data(), accumulator.data()); },
+                       [&](size_t index) { multiply(accumulator.data(), powers.data() + index * n, accumulator.data()); });
+    }
+
+    // out of Montgomery form: accumulator * 1 * R^-1
+    std::fill(one.begin(), one.end(), 0);
+    one[0] = 1;
+    multiply(accumulator.data(), one.data(), accumulator.data());
+
+    digits_vector result(n * limbs_per_word, 0, allocator);
+    unpack_words(accumulator.data(), n, result.data());
+    return big_int(std::move(result));
+}
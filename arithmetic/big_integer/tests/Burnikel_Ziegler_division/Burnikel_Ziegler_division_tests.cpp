@@ -163,6 +163,42 @@ TEST(positive_tests, test7)
     delete logger;
 }
 
+TEST(positive_tests, test8)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+        {
+            {
+                "bigint_logs.txt",
+                logger::severity::information
+            },
+        });
+
+    std::vector<unsigned int> digits_1(6000), digits_2(2500, 0xFFFFFFFFu);
+    for (size_t i = 0; i < digits_1.size(); ++i)
+    {
+        digits_1[i] = static_cast<unsigned int>(i * 2654435761u + 12345u);
+    }
+    digits_2[0] = 7;
+
+    big_int bigint_1(digits_1, false);
+    big_int bigint_2(digits_2);
+
+    big_int expected_quotient = bigint_1;
+    expected_quotient.divide_assign(bigint_2, big_int::division_rule::trivial);
+    big_int expected_remainder = bigint_1;
+    expected_remainder.modulo_assign(bigint_2, big_int::division_rule::trivial);
+
+    big_int remainder = bigint_1;
+    remainder.modulo_assign(bigint_2, big_int::division_rule::BurnikelZiegler);
+    big_int quotient = bigint_1;
+    quotient.divide_assign(bigint_2, big_int::division_rule::BurnikelZiegler);
+
+    EXPECT_TRUE(quotient == expected_quotient);
+    EXPECT_TRUE(remainder == expected_remainder);
+
+    delete logger;
+}
+
 int main(
     int argc,
     char **argv)
@@ -163,6 +163,78 @@ TEST(positive_tests, test7)
     delete logger;
 }
 
+TEST(positive_tests, test8)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+        {
+            {
+                "bigint_logs.txt",
+                logger::severity::information
+            },
+        });
+
+    std::vector<unsigned int> digits_1(6000), digits_2(2500, 0xFFFFFFFFu);
+    for (size_t i = 0; i < digits_1.size(); ++i)
+    {
+        digits_1[i] = static_cast<unsigned int>(i * 2654435761u + 12345u);
+    }
+    digits_2[0] = 7;
+
+    big_int bigint_1(digits_1, false);
+    big_int bigint_2(digits_2);
+
+    big_int expected_quotient = bigint_1;
+    expected_quotient.divide_assign(bigint_2, big_int::division_rule::trivial);
+    big_int expected_remainder = bigint_1;
+    expected_remainder.modulo_assign(bigint_2, big_int::division_rule::trivial);
+
+    big_int remainder = bigint_1;
+    remainder.modulo_assign(bigint_2, big_int::division_rule::Newton);
+    big_int quotient = bigint_1;
+    quotient.divide_assign(bigint_2, big_int::division_rule::Newton);
+
+    EXPECT_TRUE(quotient == expected_quotient);
+    EXPECT_TRUE(remainder == expected_remainder);
+
+    delete logger;
+}
+
+TEST(positive_tests, test9)
+{
+    // divisor is long enough for reciprocal to take several Newton steps instead of one division
+    std::vector<unsigned int> digits_1(9000), digits_2(4000);
+    for (size_t i = 0; i < digits_1.size(); ++i)
+    {
+        digits_1[i] = static_cast<unsigned int>(i * 2246822519u + 3266489917u);
+    }
+    for (size_t i = 0; i < digits_2.size(); ++i)
+    {
+        digits_2[i] = static_cast<unsigned int>(i * 668265263u + 374761393u);
+    }
+
+    for (bool sign_1: {true, false})
+    {
+        for (bool sign_2: {true, false})
+        {
+            big_int bigint_1(digits_1, sign_1);
+            big_int bigint_2(digits_2, sign_2);
+
+            big_int expected_quotient = bigint_1;
+            expected_quotient.divide_assign(bigint_2, big_int::division_rule::trivial);
+            big_int expected_remainder = bigint_1;
+            expected_remainder.modulo_assign(bigint_2, big_int::division_rule::trivial);
+
+            big_int quotient = bigint_1;
+            quotient.divide_assign(bigint_2, big_int::division_rule::Newton);
+            big_int remainder = bigint_1;
+            remainder.modulo_assign(bigint_2, big_int::division_rule::Newton);
+
+            EXPECT_TRUE(quotient == expected_quotient);
+            EXPECT_TRUE(remainder == expected_remainder);
+        }
+    }
+}
+
 int main(
     int argc,
     char **argv)
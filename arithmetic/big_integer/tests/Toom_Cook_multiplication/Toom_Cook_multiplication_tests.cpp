@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <client_logger_builder.h>
+#include <sstream>
+#include <big_int.h>
+#include <client_logger.h>
+#include <client_logger_builder.h>
+
+logger *create_logger(
+    std::vector<std::pair<std::string, logger::severity>> const &output_file_streams_setup,
+    bool use_console_stream = true,
+    logger::severity console_stream_severity = logger::severity::debug)
+{
+    logger_builder *builder = new client_logger_builder();
+
+    if (use_console_stream)
+    {
+        builder->add_console_stream(console_stream_severity);
+    }
+
+    for (auto &output_file_stream_setup: output_file_streams_setup)
+    {
+        builder->add_file_stream(output_file_stream_setup.first, output_file_stream_setup.second);
+    }
+
+    logger *built_logger = builder->build();
+
+    delete builder;
+
+    return built_logger;
+}
+
+TEST(positive_tests_toom, test1)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+                                       {
+                                           {
+                                               "bigint_logs.txt",
+                                               logger::severity::information
+                                           },
+                                       });
+
+    big_int bigint_1("-28958888309635818");
+    big_int bigint_2("-234567");
+    bigint_1.multiply_assign(bigint_2, big_int::multiplication_rule::Toom3);
+
+    EXPECT_TRUE((std::ostringstream() << bigint_1).str() == "6792799554126344920806");
+
+    delete logger;
+}
+
+TEST(positive_tests_toom, test2)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+                                       {
+                                           {
+                                               "bigint_logs.txt",
+                                               logger::severity::information
+                                           },
+                                       });
+
+    big_int bigint_1("123424353464389587244387927589346894576464343235445645674563532464675467425");
+    big_int bigint_2("2354893245937465784937542389428935349086840957804985309763636567574564");
+    bigint_1.multiply_assign(bigint_2, big_int::multiplication_rule::Toom3);
+
+    EXPECT_TRUE((std::ostringstream() << bigint_1).str() == "290651176357489495451049958587923972328418314663424320128873904703658883667429195585130334492391519870913575716570325570910803505581125240577700");
+
+    delete logger;
+}
+
+TEST(positive_tests_toom, test3)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+                                       {
+                                           {
+                                               "bigint_logs.txt",
+                                               logger::severity::information
+                                           },
+                                       });
+
+    big_int bigint_1("999999999999999999999999999977777");
+    big_int bigint_2("-0000000000000000000000000000000000000000000000000059");
+    bigint_1.multiply_assign(bigint_2, big_int::multiplication_rule::Toom3);
+
+    EXPECT_TRUE((std::ostringstream() << bigint_1).str() == "-58999999999999999999999999998688843");
+
+    delete logger;
+}
+
+TEST(positive_tests_toom, test4)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+                                       {
+                                           {
+                                               "bigint_logs.txt",
+                                               logger::severity::information
+                                           },
+                                       });
+
+    std::vector<unsigned int> digits_1(3000), digits_2(2000);
+    for (size_t i = 0; i < digits_1.size(); ++i)
+    {
+        digits_1[i] = static_cast<unsigned int>(i * 2654435761u + 12345u);
+    }
+    for (size_t i = 0; i < digits_2.size(); ++i)
+    {
+        digits_2[i] = static_cast<unsigned int>(~(i * 40503u));
+    }
+
+    big_int bigint_1(digits_1, false);
+    big_int bigint_2(digits_2);
+    big_int expected = bigint_1;
+    expected.multiply_assign(bigint_2, big_int::multiplication_rule::trivial);
+    bigint_1.multiply_assign(bigint_2, big_int::multiplication_rule::Toom3);
+
+    EXPECT_TRUE(bigint_1 == expected);
+
+    delete logger;
+}
+
+int main(
+    int argc,
+    char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
\ No newline at end of file
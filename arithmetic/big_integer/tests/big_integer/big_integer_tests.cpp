@@ -231,6 +231,196 @@ TEST(positive_tests, test9)
     delete logger;
 }
 
+TEST(positive_tests, test10)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+        {
+            {
+                "bigint_logs.txt",
+                logger::severity::information
+            },
+        });
+
+    big_int bigint_1("-ffFFffFF00000001", 16);
+    big_int bigint_2("zz", 36);
+
+    EXPECT_EQ(bigint_1.to_string(), "-18446744069414584321");
+    EXPECT_EQ(bigint_1.to_string(16), "-ffffffff00000001");
+    EXPECT_EQ(bigint_2.to_string(7), "3530");
+    EXPECT_THROW(big_int("129", 8), std::invalid_argument);
+    EXPECT_THROW((void) bigint_2.to_string(37), std::invalid_argument);
+
+    delete logger;
+}
+
+TEST(positive_tests, test11)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+        {
+            {
+                "bigint_logs.txt",
+                logger::severity::information
+            },
+        });
+
+    std::string digits = "1";
+    for (int i = 0; i < 20000; ++i)
+    {
+        digits += static_cast<char>('0' + (i * 7 + 3) % 10);
+    }
+
+    big_int bigint_1(digits);
+    big_int bigint_2(bigint_1.to_string(3), 3);
+
+    EXPECT_EQ(bigint_1.to_string(), digits);
+    EXPECT_TRUE(bigint_1 == bigint_2);
+
+    delete logger;
+}
+
+TEST(positive_tests, test12)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+        {
+            {
+                "bigint_logs.txt",
+                logger::severity::information
+            },
+        });
+
+    // consecutive Fibonacci numbers are coprime and take the longest Euclid sequence
+    big_int previous(1), current(1);
+    for (int i = 0; i < 5000; ++i)
+    {
+        big_int next = previous + current;
+        previous = std::move(current);
+        current = std::move(next);
+    }
+
+    big_int common("98765432109876543210987654321098765432109876543210");
+
+    EXPECT_TRUE(gcd(current * common, previous * common) == common);
+    EXPECT_TRUE(gcd(current, previous) == 1);
+    EXPECT_TRUE(gcd(big_int(-12), big_int(18)) == 6);
+    EXPECT_TRUE(gcd(big_int(0), big_int(-5)) == 5);
+    EXPECT_TRUE(gcd(big_int(0), big_int(0)) == 0);
+
+    delete logger;
+}
+
+TEST(positive_tests, test13)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+        {
+            {
+                "bigint_logs.txt",
+                logger::severity::information
+            },
+        });
+
+    // values cross inline storage of four limbs both ways
+    big_int value(1);
+    for (int i = 0; i < 200; ++i)
+    {
+        value = value * 3 + 1;
+    }
+    big_int copy = value;
+    big_int moved = std::move(copy);
+    EXPECT_TRUE(moved == value);
+
+    big_int shrunk = value >> (value.bit_length() - 64);
+    big_int small = shrunk;
+    EXPECT_TRUE(small.bit_length() == 64);
+    EXPECT_TRUE((small << (value.bit_length() - 64)) + (value % (1_bi << (value.bit_length() - 64))) == value);
+
+    big_int grown(123456789);
+    grown <<= 100;
+    grown >>= 100;
+    EXPECT_TRUE(grown == 123456789);
+
+    big_int inline_value(42);
+    inline_value = std::move(moved);
+    EXPECT_TRUE(inline_value == value);
+    moved = big_int(7);
+    EXPECT_TRUE(moved == 7);
+    EXPECT_TRUE((big_int("340282366920938463463374607431768211455") + 1).to_string() == "340282366920938463463374607431768211456");
+
+    delete logger;
+}
+
+TEST(positive_tests, test14)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+        {
+            {
+                "bigint_logs.txt",
+                logger::severity::information
+            },
+        });
+
+    big_int a("-98765432109876543210987654321098765432109876543210");
+    big_int b("12345678901234567890123456789");
+    big_int c("55555555555555555555555555555555555555555555555555555555555555555555555555");
+
+    big_int sum = a + b, difference = a - b, product = a * b;
+    EXPECT_TRUE(big_int(a) + b == sum && a + big_int(b) == sum && big_int(a) + big_int(b) == sum);
+    EXPECT_TRUE(big_int(a) - b == difference && a - big_int(b) == difference && big_int(a) - big_int(b) == difference);
+    EXPECT_TRUE(big_int(a) * b == product && big_int(c) / b == c / b && big_int(c) % b == c % b);
+    EXPECT_TRUE(b - big_int(b) == 0);
+
+    big_int accumulated = c;
+    accumulated.addmul(a, b);
+    EXPECT_TRUE(accumulated == c + product);
+    accumulated.submul(a, b);
+    EXPECT_TRUE(accumulated == c);
+
+    // product of opposite sign and operand aliasing this
+    accumulated.submul(c, c);
+    EXPECT_TRUE(accumulated == c - c * c);
+    accumulated = b;
+    accumulated.addmul(accumulated, b);
+    EXPECT_TRUE(accumulated == b + b * b);
+
+    big_int zero;
+    zero.submul(a, b);
+    EXPECT_TRUE(zero == 0_bi - product);
+
+    delete logger;
+}
+
+TEST(positive_tests, test15)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>
+        {
+            {
+                "bigint_logs.txt",
+                logger::severity::information
+            },
+        });
+
+    big_int mersenne_127 = (1_bi << 127) - 1;
+    EXPECT_TRUE(big_int(5).pow_mod(mersenne_127 - 1, mersenne_127) == 1);
+    EXPECT_TRUE(big_int(5).pow_mod(mersenne_127 - 1, mersenne_127, true) == 1);
+
+    // even modulus goes through division, negative base is taken modulo
+    EXPECT_TRUE(big_int(3).pow_mod(1_bi << 100, big_int("100000000000000000000")).to_string() == "76270127791781969921");
+    EXPECT_TRUE(big_int(-7).pow_mod(big_int("12345678901234567890"), (1_bi << 89) - 1).to_string() == "315696200456334613955984819");
+
+    big_int::montgomery_context context((1_bi << 521) - 1);
+    big_int expected("5921834106190476422390951917222503486423700251473292008279119953818768779407141894028596715217168061251114547875403165381460910354413553364096345716310189558");
+    EXPECT_TRUE(big_int(123456789).pow_mod(65537, context) == expected);
+    EXPECT_TRUE(big_int(123456789).pow_mod(65537, context, true) == expected);
+    EXPECT_TRUE(big_int(123456789).pow_mod(0, context, true) == 1);
+    EXPECT_TRUE(big_int(123456789).pow_mod(0, 1) == 0);
+
+    EXPECT_THROW(big_int(2).pow_mod(-1, 7), std::invalid_argument);
+    EXPECT_THROW(big_int(2).pow_mod(3, 0), std::invalid_argument);
+    EXPECT_THROW(big_int(2).pow_mod(3, 8, true), std::invalid_argument);
+    EXPECT_THROW(big_int::montgomery_context(big_int(10)), std::invalid_argument);
+
+    delete logger;
+}
+
 int main(
     int argc,
     char **argv)
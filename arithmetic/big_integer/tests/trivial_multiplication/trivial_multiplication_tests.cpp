@@ -165,6 +165,25 @@ TEST(positive_tests, test7)
     delete logger;
 }
 
+TEST(positive_tests, test8)
+{
+    // all limbs are 0xFFFFFFFF, so every column carries, odd and even lengths take different paths
+    for (size_t a_size = 1; a_size <= 9; ++a_size)
+    {
+        for (size_t b_size = 1; b_size <= 9; ++b_size)
+        {
+            big_int one("1");
+            big_int a = (one << (32 * a_size)) - one;
+            big_int b = (one << (32 * b_size)) - one;
+            big_int expected = (one << (32 * (a_size + b_size))) - (one << (32 * a_size)) - (one << (32 * b_size)) + one;
+
+            a.multiply_assign(b, big_int::multiplication_rule::trivial);
+
+            EXPECT_EQ(a, expected) << a_size << " x " << b_size << " limbs";
+        }
+    }
+}
+
 int main(
     int argc,
     char **argv)
@@ -0,0 +1,161 @@
+// Measures crossover sizes of big_int algorithms on current machine and writes big_int_thresholds.h:
+// mp_os_arthmtc_bg_intgr_tn [output path, stdout if absent]
+// build in Release, thresholds take effect after big_int is rebuilt
+
+#include <big_int.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    std::mt19937 generator(42);
+
+    big_int random_number(size_t limbs) {
+        std::vector<unsigned int> digits(limbs);
+        for (auto &digit: digits) {
+            digit = static_cast<unsigned int>(generator());
+        }
+        digits.back() |= 1u << 31;
+        return big_int(digits);
+    }
+
+    // seconds per call, best of 5 runs of at least 10 ms each, so that noise of other processes is filtered out
+    template<typename Operation>
+    double measure(Operation &&operation) {
+        size_t repeats = 1;
+        double best = 0;
+        for (size_t run = 0; run < 5;) {
+            auto begin = clock_type::now();
+            for (size_t i = 0; i < repeats; ++i) {
+                operation();
+            }
+            std::chrono::duration<double> elapsed = clock_type::now() - begin;
+            if (elapsed.count() < 0.01) {
+                repeats *= 2;
+                continue;
+            }
+
+            double per_call = elapsed.count() / static_cast<double>(repeats);
+            best = run++ == 0 ? per_call : std::min(best, per_call);
+        }
+        return best;
+    }
+
+    double operation_time(size_t limbs, big_int::multiplication_rule rule) {
+        big_int a = random_number(limbs), b = random_number(limbs);
+        return measure([&] {
+            big_int result = a;
+            result.multiply_assign(b, rule);
+        });
+    }
+
+    // divisor of limbs and quotient of limbs
+    double operation_time(size_t limbs, big_int::division_rule rule) {
+        big_int a = random_number(2 * limbs), b = random_number(limbs);
+        return measure([&] {
+            big_int result = a;
+            result.divide_assign(b, rule);
+        });
+    }
+
+    /** Smallest size from which faster rule wins at this and next two measured sizes,
+     *  SIZE_MAX if it doesn't happen up to to, so that faster rule is never chosen
+     */
+    template<typename Rule>
+    size_t crossover(Rule slower, Rule faster, size_t from, size_t to) {
+        size_t wins = 0, candidate = SIZE_MAX;
+        for (size_t size = from; size <= to; size += std::max<size_t>(1, size / 8)) {
+            double slower_time = operation_time(size, slower);
+            double faster_time = operation_time(size, faster);
+            std::cerr << "  " << size << " limbs: " << slower_time * 1e6 << " us vs " << faster_time * 1e6 << " us" << std::endl;
+
+            if (faster_time < slower_time) {
+                if (wins++ == 0) candidate = size;
+                if (wins == 3) return candidate;
+            } else {
+                wins = 0;
+                candidate = SIZE_MAX;
+            }
+        }
+
+        std::cerr << "  warning: no stable crossover up to " << to << " limbs, faster rule is disabled" << std::endl;
+        return SIZE_MAX;
+    }
+
+    // next search starts at previous threshold, or at floor if previous rule is disabled
+    size_t search_from(size_t threshold, size_t floor) {
+        return threshold == SIZE_MAX ? floor : std::max(threshold, floor);
+    }
+
+    std::string threshold_to_string(size_t threshold) {
+        return threshold == SIZE_MAX ? "SIZE_MAX" : std::to_string(threshold);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::cerr << "trivial -> Karatsuba" << std::endl;
+    size_t karatsuba = crossover(big_int::multiplication_rule::trivial, big_int::multiplication_rule::Karatsuba, 8, 256);
+
+    auto below_toom3 = karatsuba == SIZE_MAX ? big_int::multiplication_rule::trivial : big_int::multiplication_rule::Karatsuba;
+    std::cerr << "Karatsuba -> Toom3" << std::endl;
+    size_t toom3 = crossover(below_toom3, big_int::multiplication_rule::Toom3, search_from(karatsuba, 24), 8192);
+
+    auto below_ntt = toom3 == SIZE_MAX ? below_toom3 : big_int::multiplication_rule::Toom3;
+    std::cerr << "Toom3 -> SchonhageStrassen" << std::endl;
+    size_t ntt = crossover(below_ntt, big_int::multiplication_rule::SchonhageStrassen, search_from(toom3, 256), 131072);
+
+    std::cerr << "trivial -> BurnikelZiegler" << std::endl;
+    size_t burnikel_ziegler = crossover(big_int::division_rule::trivial, big_int::division_rule::BurnikelZiegler, 16, 4096);
+
+    auto below_newton = burnikel_ziegler == SIZE_MAX ? big_int::division_rule::trivial : big_int::division_rule::BurnikelZiegler;
+    std::cerr << "BurnikelZiegler -> Newton" << std::endl;
+    size_t newton = crossover(below_newton, big_int::division_rule::Newton, search_from(burnikel_ziegler, 256), 131072);
+
+    // decide_mult and decide_div check thresholds in order, so rule disabled in the middle must not hide the next one
+    toom3 = std::min(toom3, ntt);
+    karatsuba = std::min(karatsuba, toom3);
+    burnikel_ziegler = std::min(burnikel_ziegler, newton);
+
+    std::ostringstream header;
+    header << "#ifndef MP_OS_BIG_INT_THRESHOLDS_H\n"
+              "#define MP_OS_BIG_INT_THRESHOLDS_H\n"
+              "\n"
+              "#include <cstddef>\n"
+              "#include <cstdint>\n"
+              "\n"
+              "/** Crossover sizes in limbs of the shorter operand for big_int::decide_mult\n"
+              " *  and of the shorter of divisor and quotient for big_int::decide_div.\n"
+              " *  SIZE_MAX means the rule never won in the tuner's search range and is not chosen.\n"
+              " *  Regenerate for current machine with mp_os_arthmtc_bg_intgr_tn <path to this file>\n"
+              " */\n"
+              "namespace big_int_thresholds {\n"
+           << "    constexpr size_t karatsuba_multiplication = " << threshold_to_string(karatsuba) << ";\n"
+           << "    constexpr size_t toom3_multiplication = " << threshold_to_string(toom3) << ";\n"
+           << "    constexpr size_t ntt_multiplication = " << threshold_to_string(ntt) << ";\n"
+           << "    constexpr size_t burnikel_ziegler_division = " << threshold_to_string(burnikel_ziegler) << ";\n"
+           << "    constexpr size_t newton_division = " << threshold_to_string(newton) << ";\n"
+           << "}// namespace big_int_thresholds\n"
+              "\n"
+              "#endif //MP_OS_BIG_INT_THRESHOLDS_H\n";
+
+    if (argc > 1) {
+        std::ofstream file(argv[1]);
+        if (!file.is_open()) {
+            std::cerr << "Can't open file " << argv[1] << std::endl;
+            return 1;
+        }
+        file << header.str();
+    } else {
+        std::cout << header.str();
+    }
+    return 0;
+}
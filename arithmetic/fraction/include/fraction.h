@@ -3,15 +3,45 @@
 
 #include <big_int.h>
 #include <concepts>
+#include <span>
+#include <vector>
 
 class fraction final {
 
+public:
+    /** eager: every operation leaves the fraction reduced.
+     *  lazy: gcd is postponed until output, switching back to eager or the numbers growing past
+     *  lazy_reduction_bits, comparisons work on unreduced values
+     */
+    enum class normalization {
+        eager,
+        lazy
+    };
+
+    static constexpr size_t lazy_reduction_bits = 4096;
+
 private:
     big_int _numerator;
-    big_int _denominator;
+    big_int _denominator;// always positive
+
+    normalization _normalization = normalization::eager;
+    bool _reduced = true;
 
     void optimise();
 
+    /** Result of operation with other: reduces it if this is eager and some of operands wasn't reduced,
+     *  in lazy mode only checks size
+     */
+    void after_operation(bool operands_reduced);
+
+    /** Smallest b with 2^-b <= epsilon, functions below keep their error under 2^-b
+     */
+    static size_t precision_bits(fraction const &epsilon);
+
+    /** value / 2^scale, reduced by dropping common trailing zero bits instead of gcd
+     */
+    static fraction from_fixed(big_int value, size_t scale);
+
 public:
     /** Perfect forwarding ctor
      */
@@ -24,6 +54,12 @@ public:
 
     fraction(pp_allocator<big_int::value_type> = pp_allocator<big_int::value_type>());
 
+    /** Switching to eager reduces pending value
+     */
+    fraction &set_normalization(normalization mode) &;
+
+    normalization get_normalization() const noexcept;
+
 public:
     fraction &operator+=(fraction const &other) &;
 
@@ -92,6 +128,17 @@ public:
     fraction ln(fraction const &epsilon = fraction(1_bi, 1000000_bi)) const;
 
     fraction lg(fraction const &epsilon = fraction(1_bi, 1000000_bi)) const;
+
+public:
+    /** Same results as calling ln and root for every value, computed by up to threads threads
+     *  (hardware concurrency for 0). ln 2 is computed once for every working precision the values need.
+     *  Values are read concurrently, so their allocators must be thread-safe
+     */
+    static std::vector<fraction> ln_batch(std::span<const fraction> values,
+                                          fraction const &epsilon = fraction(1_bi, 1000000_bi), size_t threads = 0);
+
+    static std::vector<fraction> root_batch(std::span<const fraction> values, size_t degree,
+                                            fraction const &epsilon = fraction(1_bi, 1000000_bi), size_t threads = 0);
 };
 
 #endif//MP_OS_FRACTION_H
\ No newline at end of file
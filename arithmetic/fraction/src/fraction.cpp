@@ -1,43 +1,471 @@
 #include "../include/fraction.h"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <exception>
+#include <map>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
-big_int gcd(big_int a, big_int b) {
-    if (a < 0) a = 0_bi - a;
-    if (b < 0) b = 0_bi - b;
+namespace {
+    // |value| >= 2^fraction::lazy_reduction_bits
+    bool exceeds_lazy_limit(const big_int &value) noexcept {
+        return value.bit_length() > fraction::lazy_reduction_bits;
+    }
+
+    // continued fraction terms compared by operator<=> before falling back to cross multiplication
+    constexpr size_t comparison_steps = 4;
+
+    int sign_of(const big_int &value) {
+        return !value ? 0 : (value > 0 ? 1 : -1);
+    }
+
+    /** Compares |a| * d with |c| * b by bit lengths only: length of product is sum of lengths or one less.
+     *  Returns 0 if estimates overlap
+     */
+    int compare_by_length(const big_int &a, const big_int &b, const big_int &c, const big_int &d) noexcept {
+        size_t left = a.bit_length() + d.bit_length();
+        size_t right = c.bit_length() + b.bit_length();
+        if (left > right + 1) return 1;
+        if (right > left + 1) return -1;
+        return 0;
+    }
+
+    /** Compares a/b with c/d for positive a, b, c, d by their continued fraction expansions:
+     *  first differing integer part decides, equal ones are dropped and remainders are compared inverted
+     */
+    std::strong_ordering compare_positive(big_int a, big_int b, big_int c, big_int d) {
+        bool reversed = false;
+        auto oriented = [&reversed](std::strong_ordering order) {
+            return reversed ? 0 <=> order : order;
+        };
+
+        for (size_t step = 0; step < comparison_steps; ++step) {
+            big_int a_int = a / b;
+            big_int c_int = c / d;
+            if (a_int != c_int) return oriented(a_int <=> c_int);
+
+            if (a_int) a.submul(a_int, b);
+            if (c_int) c.submul(c_int, d);
+            if (!a || !c) return oriented(sign_of(a) <=> sign_of(c));
+
+            std::swap(a, b);
+            std::swap(c, d);
+            reversed = !reversed;
+
+            int estimate = compare_by_length(a, b, c, d);
+            if (estimate != 0) return oriented(estimate <=> 0);
+        }
+
+        return oriented(a * d <=> c * b);
+    }
+
+    //region series
+
+    /** Binary splitting of sum over n in [l, r) of p(l)...p(n) / (q(l)...q(n) b(n)), which equals t / (b q)
+     */
+    struct series_split {
+        big_int p;
+        big_int q;
+        big_int b;
+        big_int t;
+    };
+
+    struct series_term {
+        big_int p;
+        big_int q;
+        big_int b;
+    };
+
+    template<class Term>
+    series_split split_series(size_t l, size_t r, const Term &term) {
+        if (r - l == 1) {
+            series_term leaf = term(l);
+            big_int t = leaf.p;
+            return {std::move(leaf.p), std::move(leaf.q), std::move(leaf.b), std::move(t)};
+        }
+
+        size_t m = l + (r - l) / 2;
+        series_split left = split_series(l, m, term);
+        series_split right = split_series(m, r, term);
 
-    while (b != 0) {
-        big_int tmp = b;
-        b = a % b;
-        a = tmp;
+        big_int t = right.b * right.q * left.t;
+        t.addmul(left.b * left.p, right.t);
+        return {left.p * right.p, left.q * right.q, left.b * right.b, std::move(t)};
     }
 
-    return a;
+    /** Sum of first count terms as integer scaled by 2^scale, truncation error is below one unit
+     */
+    template<class Term>
+    big_int sum_series(size_t count, const Term &term, size_t scale) {
+        if (count == 0) return 0_bi;
+        series_split sum = split_series(0, count, term);
+        return (sum.t << scale) / (sum.b * sum.q);
+    }
+
+    /** Smallest n such that first * ratio(1) * ... * ratio(n) < 2^-bits, everything in log2
+     */
+    template<class Ratio>
+    size_t series_length(double log2_first, const Ratio &log2_ratio, size_t bits) {
+        size_t n = 0;
+        for (double bound = log2_first; bound >= -static_cast<double>(bits); bound += log2_ratio(n)) {
+            ++n;
+        }
+        return n;
+    }
+
+    // log2 |value| for nonzero value, only used to bound series lengths
+    double log2_abs(const big_int &value) {
+        size_t bits = value.bit_length();
+        size_t shift = bits > 53 ? bits - 53 : 0;
+        return std::log2(std::fabs(std::stod((value >> shift).to_string()))) + static_cast<double>(shift);
+    }
+
+    // number of trailing zero bits of nonzero value
+    size_t trailing_zeros(const big_int &value) {
+        big_int magnitude = value < 0 ? 0_bi - value : value;
+        return (magnitude ^ (magnitude - 1)).bit_length() - 1;
+    }
+
+    /** floor(value^(1/degree)) for value >= 0 and degree >= 2 by Newton's iterations from above,
+     *  leading half of bits is found recursively, so only a couple of full-size iterations remain
+     */
+    big_int nth_root(const big_int &value, size_t degree) {
+        size_t root_bits = (value.bit_length() + degree - 1) / degree;
+        if (root_bits == 0) return 0_bi;
+
+        big_int root;
+        if (root_bits <= 64) {
+            root = 1_bi << root_bits;
+        } else {
+            size_t shift = root_bits / 2;
+            root = (nth_root(value >> (degree * shift), degree) + 1) << shift;
+        }
+
+        big_int lower_degree(degree - 1);
+        while (true) {
+            big_int power = root;
+            for (size_t i = 2; i < degree; ++i) {
+                power *= root;
+            }
+
+            big_int next = (root * lower_degree + value / power) / big_int(degree);
+            if (next >= root) return root;
+            root = std::move(next);
+        }
+    }
+
+    //endregion series
+
+    //region fixed point functions
+
+    /** Dyadic fixed point: everything below returns value of function multiplied by 2^scale, error is below
+     *  two units. Intermediate values carry a few guard bits over scale and are truncated after every step,
+     *  so their size follows requested precision. Arguments are u / v with v > 0
+     */
+
+    big_int sin_fixed(const big_int &u, const big_int &v, size_t scale, bool cosine) {
+        if (!u) return cosine ? 1_bi << scale : 0_bi;
+
+        // arguments above 1 are halved and restored by double angle formulas, halving further costs more in
+        // doublings than it saves in series length
+        double log2_x = log2_abs(u) - log2_abs(v);
+        size_t halvings = log2_x > 0 ? static_cast<size_t>(std::ceil(log2_x)) : 0;
+        log2_x -= static_cast<double>(halvings);
+
+        // every doubling multiplies error by at most 4
+        size_t guard = 2 * halvings + 4;
+        size_t working = scale + guard;
+
+        big_int reduced = v << halvings;
+        big_int u2 = u * u;
+        big_int reduced2 = reduced * reduced;
+
+        big_int s, c;
+        if (!cosine || halvings > 0) {
+            size_t count = series_length(log2_x, [log2_x](size_t n) {
+                return 2 * log2_x - std::log2(static_cast<double>(2 * n * (2 * n + 1)));
+            }, working + 1);
+            s = sum_series(count, [&](size_t n) -> series_term {
+                if (n == 0) return {u, reduced, 1};
+                return {0_bi - u2, reduced2 * big_int(2 * n * (2 * n + 1)), 1};
+            }, working);
+        }
+        if (cosine || halvings > 0) {
+            size_t count = series_length(0.0, [log2_x](size_t n) {
+                return 2 * log2_x - std::log2(static_cast<double>((2 * n - 1) * 2 * n));
+            }, working + 1);
+            c = sum_series(count, [&](size_t n) -> series_term {
+                if (n == 0) return {1, 1, 1};
+                return {0_bi - u2, reduced2 * big_int((2 * n - 1) * 2 * n), 1};
+            }, working);
+        }
+
+        big_int one = 1_bi << working;
+        for (size_t i = 0; i < halvings; ++i) {
+            big_int doubled_s = (s * c) >> (working - 1);
+            c = ((c * c) >> (working - 1)) - one;
+            s = std::move(doubled_s);
+        }
+
+        return (cosine ? c : s) >> guard;
+    }
+
+    // 2 atanh(u / v) = ln((v + u) / (v - u)) for |u / v| <= 1/3
+    big_int log_ratio_fixed(const big_int &u, const big_int &v, size_t scale) {
+        if (!u) return 0_bi;
+
+        double log2_z = log2_abs(u) - log2_abs(v);
+        size_t count = series_length(log2_z, [log2_z](size_t n) {
+            return 2 * log2_z + std::log2(static_cast<double>(2 * n - 1) / static_cast<double>(2 * n + 1));
+        }, scale + 2);
+
+        big_int u2 = u * u;
+        big_int v2 = v * v;
+        return sum_series(count, [&](size_t n) -> series_term {
+            if (n == 0) return {u, v, 1};
+            return {u2, v2, big_int(2 * n + 1)};
+        }, scale + 1);
+    }
+
+    big_int ln2_fixed(size_t scale) {
+        return log_ratio_fixed(1_bi, 3_bi, scale);
+    }
+
+    // u / v > 0 is split into 2^m * y with y in [1/sqrt(2), sqrt(2)]
+    long long ln_exponent(const big_int &u, const big_int &v) {
+        return std::llround(log2_abs(u) - log2_abs(v));
+    }
+
+    // m * ln 2 brings error of m units
+    size_t ln_guard(long long m) {
+        return big_int(m).bit_length() + 3;
+    }
+
+    // ln 2 = 2 atanh(1/3) is taken from ln2(working scale), so it can be shared between calls
+    template<class Ln2>
+    big_int ln_fixed(const big_int &u, const big_int &v, size_t scale, const Ln2 &ln2) {
+        long long m = ln_exponent(u, v);
+        big_int a = m < 0 ? u << static_cast<size_t>(-m) : u;
+        big_int b = m > 0 ? v << static_cast<size_t>(m) : v;
+
+        size_t guard = ln_guard(m);
+        size_t working = scale + guard;
+
+        big_int result = log_ratio_fixed(a - b, a + b, working);
+        if (m != 0) {
+            result.addmul(ln2(working), big_int(m));
+        }
+        return result >> guard;
+    }
+
+    // ln(u / v) / ln(base) for base >= 2
+    big_int log_fixed(const big_int &u, const big_int &v, unsigned int base, size_t scale) {
+        // error of quotient grows with its size, which is at most |log2(u / v)| + 1
+        auto magnitude = static_cast<unsigned long long>(std::ceil(std::fabs(log2_abs(u) - log2_abs(v)))) + 2;
+        size_t guard = big_int(magnitude).bit_length() + 3;
+        size_t working = scale + guard;
+        big_int numerator = ln_fixed(u, v, working, ln2_fixed) << working;
+        return (numerator / ln_fixed(big_int(base), 1_bi, working, ln2_fixed)) >> guard;
+    }
+
+    big_int arctg_fixed(const big_int &u, const big_int &v, size_t scale);
+
+    // pi / 2 = 8 arctg(1/5) - 2 arctg(1/239)
+    big_int half_pi_fixed(size_t scale) {
+        size_t working = scale + 5;
+        big_int result = (arctg_fixed(1_bi, 5_bi, working) << 3) - (arctg_fixed(1_bi, 239_bi, working) << 1);
+        return result >> 5;
+    }
+
+    /** Euler's series arctg x = sum 2^2n (n!)^2 / (2n + 1)! * x^(2n + 1) / (1 + x^2)^(n + 1) with ratio
+     *  x^2 / (1 + x^2) <= 1/2 for |x| <= 1, larger arguments use arctg x = ±pi/2 - arctg(1 / x)
+     */
+    big_int arctg_fixed(const big_int &u, const big_int &v, size_t scale) {
+        if (!u) return 0_bi;
+
+        big_int abs_u = u < 0 ? 0_bi - u : u;
+        if (abs_u > v) {
+            size_t working = scale + 2;
+            big_int half_pi = half_pi_fixed(working);
+            big_int inverse = u < 0 ? arctg_fixed(0_bi - v, abs_u, working) : arctg_fixed(v, u, working);
+            return (u < 0 ? 0_bi - half_pi - inverse : half_pi - inverse) >> 2;
+        }
+
+        double log2_x = log2_abs(u) - log2_abs(v);
+        double log2_ratio = 2 * log2_x - std::log2(1 + std::exp2(2 * log2_x));
+        size_t count = series_length(0.0, [log2_ratio](size_t) {
+            return log2_ratio;
+        }, scale + 2);
+
+        big_int u2 = u * u;
+        big_int sum_squares = u2 + v * v;
+        return sum_series(count, [&](size_t n) -> series_term {
+            if (n == 0) return {u * v, sum_squares, 1};
+            return {u2 * big_int(2 * n), sum_squares * big_int(2 * n + 1), 1};
+        }, scale);
+    }
+
+    // leading bits taken off the argument by first step of arctg_burst_fixed, doubled on every next step
+    constexpr size_t burst_bits = 16;
+
+    /** arctg(t / 2^scale) for |t| <= 2^scale by bit-burst: step k takes argument x rounded to
+     *  burst_bits * 2^k bits as short rational t_k and continues with (x - t_k) / (1 + x t_k) < 2^-(burst_bits * 2^k),
+     *  so every series stays short in both terms and their length
+     */
+    big_int arctg_burst_fixed(const big_int &t, size_t scale) {
+        // fewer than 64 steps, each adds less than 4 units of error
+        size_t guard = 8;
+        size_t working = scale + guard;
+        big_int one = 1_bi << working;
+
+        big_int x = t << guard;
+        big_int result = 0;
+        for (size_t bits = burst_bits; x; bits *= 2) {
+            if (bits >= working) {
+                result += arctg_fixed(x, one, working);
+                break;
+            }
+
+            big_int head = x >> (working - bits);
+            if (!head) continue;
+
+            result += arctg_fixed(head, 1_bi << bits, working);
+            head <<= working - bits;
+            x = ((x - head) << working) / (one + ((x * head) >> working));
+        }
+        return result >> guard;
+    }
+
+    // arcsin x = 2 arctg(x / (1 + sqrt(1 - x^2))) for |x| <= 1, argument of arctg is always in [-1, 1]
+    big_int arcsin_fixed(const big_int &u, const big_int &v, size_t scale) {
+        size_t working = scale + 4;
+        big_int v2 = v * v;
+        big_int root = nth_root(((v2 - u * u) << (2 * working)) / v2, 2);
+        big_int t = (u << (2 * working)) / (v * ((1_bi << working) + root));
+        return arctg_burst_fixed(t, working) >> (working - scale - 1);
+    }
+
+    //endregion fixed point functions
+
+    /** Calls task(i) for every i in [0, count) from up to threads threads (hardware concurrency for 0),
+     *  including calling one. Indices are taken from shared counter, first exception is rethrown after join
+     */
+    template<class Task>
+    void parallel_for(size_t count, size_t threads, const Task &task) {
+        if (threads == 0) threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        threads = std::min(threads, count);
+
+        std::atomic<size_t> next = 0;
+        std::exception_ptr error;
+        std::mutex error_mut;
+
+        auto worker = [&] {
+            try {
+                for (size_t i = next++; i < count; i = next++) {
+                    task(i);
+                }
+            } catch (...) {
+                std::lock_guard lock(error_mut);
+                if (!error) error = std::current_exception();
+                next = count;
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < threads; ++i) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto &thread: pool) {
+            thread.join();
+        }
+
+        if (error) std::rethrow_exception(error);
+    }
 }
 
 void fraction::optimise() {
     if (_denominator == 0) throw std::invalid_argument("Denominator cannot be zero");
+    _reduced = true;
     if (_numerator == 0) {
         _denominator = 1;
         return;
     }
 
     big_int divisor = gcd(_numerator, _denominator);
-    _numerator /= divisor;
-    _denominator /= divisor;
+    if (divisor != 1) {
+        _numerator /= divisor;
+        _denominator /= divisor;
+    }
     if (_denominator < 0) {
         _numerator = 0_bi - _numerator;
         _denominator = 0_bi - _denominator;
     }
 }
 
+void fraction::after_operation(bool operands_reduced) {
+    if (_normalization == normalization::lazy) {
+        _reduced = false;
+        if (exceeds_lazy_limit(_numerator) || exceeds_lazy_limit(_denominator)) {
+            optimise();
+        }
+    } else if (!operands_reduced) {
+        optimise();
+    }
+}
+
 fraction::fraction(const pp_allocator<big_int::value_type> allocator)
         : _numerator(0, allocator), _denominator(1, allocator) {}
 
+fraction &fraction::set_normalization(normalization mode) & {
+    _normalization = mode;
+    if (mode == normalization::eager && !_reduced) {
+        optimise();
+    }
+    return *this;
+}
+
+fraction::normalization fraction::get_normalization() const noexcept {
+    return _normalization;
+}
+
 fraction& fraction::operator+=(fraction const& other) & {
-    _numerator = _numerator * other._denominator + _denominator * other._numerator;
-    _denominator = _denominator * other._denominator;
-    optimise();
+    bool reduced = _reduced && other._reduced;
+
+    if (_normalization == normalization::eager && reduced) {
+        // Henrici: with g = gcd(b, d) only factors of g can cancel in a/b + c/d
+        big_int g = gcd(_denominator, other._denominator);
+        if (g == 1) {
+            big_int numerator = _numerator * other._denominator;
+            numerator.addmul(_denominator, other._numerator);
+            _numerator = std::move(numerator);
+            _denominator *= other._denominator;
+        } else {
+            big_int this_part = _denominator / g;
+            big_int numerator = _numerator * (other._denominator / g);
+            numerator.addmul(this_part, other._numerator);
+            _numerator = std::move(numerator);
+
+            big_int h = _numerator == 0 ? g : gcd(_numerator, g);
+            if (h != 1) {
+                _numerator /= h;
+            }
+            _denominator = this_part * (other._denominator / h);
+        }
+
+        if (_numerator == 0) {
+            _denominator = 1;
+        }
+        return *this;
+    }
+
+    big_int numerator = _numerator * other._denominator;
+    numerator.addmul(_denominator, other._numerator);
+    _numerator = std::move(numerator);
+    _denominator *= other._denominator;
+    after_operation(reduced);
     return *this;
 }
 
@@ -48,10 +476,7 @@ fraction fraction::operator+(fraction const& other) const {
 }
 
 fraction& fraction::operator-=(fraction const& other) & {
-    _numerator = _numerator * other._denominator - _denominator * other._numerator;
-    _denominator = _denominator * other._denominator;
-    optimise();
-    return *this;
+    return *this += -other;
 }
 
 fraction fraction::operator-(fraction const& other) const {
@@ -61,9 +486,25 @@ fraction fraction::operator-(fraction const& other) const {
 }
 
 fraction& fraction::operator*=(fraction const& other) & {
+    bool reduced = _reduced && other._reduced;
+
+    if (_normalization == normalization::eager && reduced) {
+        // a/b * c/d of reduced fractions can only cancel across: gcd(a, d) and gcd(c, b)
+        big_int left = gcd(_numerator, other._denominator);
+        big_int right = gcd(other._numerator, _denominator);
+
+        _numerator = (left == 1 ? _numerator : _numerator / left) * (right == 1 ? other._numerator : other._numerator / right);
+        _denominator = (right == 1 ? _denominator : _denominator / right) * (left == 1 ? other._denominator : other._denominator / left);
+
+        if (_numerator == 0) {
+            _denominator = 1;
+        }
+        return *this;
+    }
+
     _numerator *= other._numerator;
     _denominator *= other._denominator;
-    optimise();
+    after_operation(reduced);
     return *this;
 }
 
@@ -75,10 +516,14 @@ fraction fraction::operator*(fraction const& other) const {
 
 fraction& fraction::operator/=(fraction const& other) & {
     if (other._numerator == 0) throw std::invalid_argument("Division by zero");
-    _numerator *= other._denominator;
-    _denominator *= other._numerator;
-    optimise();
-    return *this;
+
+    fraction inverse = other;
+    std::swap(inverse._numerator, inverse._denominator);
+    if (inverse._denominator < 0) {
+        inverse._numerator = 0_bi - inverse._numerator;
+        inverse._denominator = 0_bi - inverse._denominator;
+    }
+    return *this *= inverse;
 }
 
 fraction fraction::operator/(fraction const& other) const {
@@ -94,15 +539,23 @@ fraction fraction::operator-() const {
 }
 
 bool fraction::operator==(fraction const& other) const noexcept {
-    return _numerator == other._numerator && _denominator == other._denominator;
+    if (_reduced && other._reduced) {
+        return _numerator == other._numerator && _denominator == other._denominator;
+    }
+    return _numerator * other._denominator == _denominator * other._numerator;
 }
 
 std::partial_ordering fraction::operator<=>(const fraction& other) const noexcept {
-    big_int l_val = _numerator * other._denominator;
-    big_int r_val = _denominator * other._numerator;
-    if (l_val < r_val) return std::partial_ordering::less;
-    if (l_val > r_val) return std::partial_ordering::greater;
-    return std::partial_ordering::equivalent;
+    // denominators are positive, so fractions of different signs are ordered by numerators alone
+    int sign = sign_of(_numerator);
+    int other_sign = sign_of(other._numerator);
+    if (sign != other_sign || sign == 0) return sign <=> other_sign;
+
+    int estimate = compare_by_length(_numerator, _denominator, other._numerator, other._denominator);
+    if (estimate != 0) return (sign * estimate) <=> 0;
+
+    if (sign > 0) return compare_positive(_numerator, _denominator, other._numerator, other._denominator);
+    return compare_positive(0_bi - other._numerator, other._denominator, 0_bi - _numerator, _denominator);
 }
 
 std::ostream &operator<<(std::ostream &stream, fraction const &obj) {
@@ -159,45 +612,45 @@ std::istream& operator>>(std::istream& stream, fraction& obj) {
 }
 
 std::string fraction::to_string() const {
+    if (!_reduced) {
+        fraction reduced = *this;
+        reduced.optimise();
+        return reduced.to_string();
+    }
+
     std::stringstream ss;
     ss << _numerator << "/" << _denominator;
     return ss.str();
 }
 
-fraction fraction::sin(fraction const& epsilon) const {
-    auto x = *this;
-    fraction result(0, 1);
-    fraction term = x;
-    int n = 1;
-    fraction prev_result;
-
-    do {
-        prev_result = result;
-        result += term;
-        term = term * (-x * x) / fraction((2*n)*(2*n + 1), 1);
-        n++;
-    } while ((result - prev_result > epsilon) || (prev_result - result > epsilon));
+size_t fraction::precision_bits(fraction const& epsilon) {
+    if (epsilon._numerator <= 0) throw std::invalid_argument("Epsilon must be positive");
 
-    return result;
+    size_t numerator_bits = epsilon._numerator.bit_length();
+    size_t denominator_bits = epsilon._denominator.bit_length();
+    return denominator_bits > numerator_bits ? denominator_bits - numerator_bits + 1 : 1;
 }
 
-fraction fraction::cos(fraction const& epsilon) const {
-    auto x = *this;
-    fraction result(1, 1);
-    fraction term(1, 1);
-    int n = 1;
-    fraction prev_result;
-
-    do {
-        prev_result = result;
-        term = term * (-x * x) / fraction((2*n - 1)*(2*n), 1);
-        result += term;
-        n++;
-    } while ((result - prev_result > epsilon) || (prev_result - result > epsilon));
+fraction fraction::from_fixed(big_int value, size_t scale) {
+    fraction result;
+    if (!value) return result;
 
+    size_t shift = std::min(trailing_zeros(value), scale);
+    result._numerator = value >> shift;
+    result._denominator = 1_bi << (scale - shift);
     return result;
 }
 
+fraction fraction::sin(fraction const& epsilon) const {
+    size_t scale = precision_bits(epsilon) + 1;
+    return from_fixed(sin_fixed(_numerator, _denominator, scale, false), scale);
+}
+
+fraction fraction::cos(fraction const& epsilon) const {
+    size_t scale = precision_bits(epsilon) + 1;
+    return from_fixed(sin_fixed(_numerator, _denominator, scale, true), scale);
+}
+
 fraction fraction::tg(fraction const& epsilon) const {
     auto c = cos(epsilon * epsilon);
     if (c._numerator == 0) throw std::domain_error("Tangent undefined");
@@ -227,50 +680,23 @@ fraction fraction::arcsin(const fraction& epsilon) const {
         throw std::domain_error("Arcsin undefined for |x| > 1");
     }
 
-    fraction x = *this;
-    fraction result(0, 1);
-    fraction term = x;
-    big_int n = 1;
-    fraction prev_result;
-
-    do {
-        prev_result = result;
-        result += term;
-        term = term * x * x * fraction((2_bi *n - 1)*(2_bi *n - 1), (2_bi*n)*(2_bi*n + 1));
-        n += 1;
-    } while ((result - prev_result > epsilon) || (prev_result - result > epsilon));
-
-    return result;
+    size_t scale = precision_bits(epsilon) + 1;
+    return from_fixed(arcsin_fixed(_numerator, _denominator, scale), scale);
 }
 
 fraction fraction::arccos(const fraction& epsilon) const {
     if (*this < fraction(-1, 1) || *this > fraction(1, 1)) {
         throw std::domain_error("Arccos undefined for |x| > 1");
     }
-    return fraction(1, 2).arcsin(epsilon) * fraction(3, 1) - arcsin(epsilon);
+
+    size_t scale = precision_bits(epsilon) + 1;
+    size_t working = scale + 2;
+    return from_fixed((half_pi_fixed(working) - arcsin_fixed(_numerator, _denominator, working)) >> 2, scale);
 }
 
 fraction fraction::arctg(fraction const &epsilon) const {
-    auto x = *this;
-
-    if (*this > fraction(1, 1)) {
-        return fraction(1, 2).arcsin(epsilon) * fraction(3, 1) -
-               (fraction(1, 1) / *this).arctg(epsilon);
-    }
-
-    fraction result(0, 1);
-    fraction term = *this;
-    big_int n = 1;
-    fraction tmp_result;
-
-    do {
-        tmp_result = result;
-        result += fraction(1, n) * term;
-        n += 2_bi;
-        term = -term * (x * x);
-    } while ((result - tmp_result > epsilon) || (tmp_result - result > epsilon));
-
-    return result;
+    size_t scale = precision_bits(epsilon) + 1;
+    return from_fixed(arctg_fixed(_numerator, _denominator, scale), scale);
 }
 
 
@@ -310,56 +736,82 @@ fraction fraction::root(size_t degree, fraction const& epsilon) const {
     if (_numerator < 0 && degree % 2 == 0)
         throw std::domain_error("Even root of negative number");
 
-    fraction x = *this;
-    if (x._numerator < 0) x = -x;
-
-    fraction guess = *this / fraction(degree, 1);
-    fraction prev_guess;
-
-    do {
-        prev_guess = guess;
-        fraction power = guess.pow(degree - 1);
-        if (power._numerator == 0)
-            throw std::logic_error("Division by zero in root calculation");
-
-        guess = (fraction(degree - 1, 1) * guess + *this / power)
-                / fraction(degree, 1);
-    } while ((guess - prev_guess > epsilon) || (prev_guess - guess > epsilon));
-
-    if (_numerator < 0 && degree % 2 == 1)
-        guess = -guess;
-
-    return guess;
+    size_t scale = precision_bits(epsilon) + 1;
+    big_int magnitude = _numerator < 0 ? 0_bi - _numerator : _numerator;
+    big_int result = nth_root((magnitude << (degree * scale)) / _denominator, degree);
+    return from_fixed(_numerator < 0 ? 0_bi - result : result, scale);
 }
 
 fraction fraction::log2(fraction const& epsilon) const {
     if (_numerator <= 0 || _denominator <= 0)
         throw std::domain_error("Logarithm of non-positive number");
-    return ln(epsilon) / fraction(2, 1).ln(epsilon);
+
+    size_t scale = precision_bits(epsilon) + 1;
+    return from_fixed(log_fixed(_numerator, _denominator, 2, scale), scale);
 }
 
 fraction fraction::ln(fraction const& epsilon) const {
     if (_numerator <= 0 || _denominator <= 0)
         throw std::domain_error("Natural logarithm of non-positive number");
 
-    fraction y = (*this - fraction(1, 1)) / (*this + fraction(1, 1));
-    fraction result(0, 1);
-    fraction term = y;
-    fraction prev_result;
-    int n = 1;
+    size_t scale = precision_bits(epsilon) + 1;
+    return from_fixed(ln_fixed(_numerator, _denominator, scale, ln2_fixed), scale);
+}
+
+std::vector<fraction> fraction::ln_batch(std::span<const fraction> values, fraction const& epsilon, size_t threads) {
+    for (auto const& value: values) {
+        if (value._numerator <= 0)
+            throw std::domain_error("Natural logarithm of non-positive number");
+    }
 
-    do {
-        prev_result = result;
-        result += term / fraction(n, 1);
-        term = term * (y * y);
-        n += 2;
-    } while ((result - prev_result > epsilon) || (prev_result - result > epsilon));
+    size_t scale = precision_bits(epsilon) + 1;
 
-    return result * fraction(2, 1);
+    // ln 2 for every working scale the inputs need
+    std::map<size_t, big_int> ln2;
+    for (auto const& value: values) {
+        long long m = ln_exponent(value._numerator, value._denominator);
+        if (m != 0) {
+            ln2.emplace(scale + ln_guard(m), big_int());
+        }
+    }
+
+    std::vector<std::map<size_t, big_int>::iterator> constants;
+    for (auto it = ln2.begin(); it != ln2.end(); ++it) {
+        constants.push_back(it);
+    }
+    parallel_for(constants.size(), threads, [&constants](size_t i) {
+        constants[i]->second = ln2_fixed(constants[i]->first);
+    });
+
+    std::vector<fraction> results(values.size());
+    parallel_for(values.size(), threads, [&](size_t i) {
+        auto shared_ln2 = [&ln2](size_t working) -> const big_int & {
+            return ln2.at(working);
+        };
+        results[i] = from_fixed(ln_fixed(values[i]._numerator, values[i]._denominator, scale, shared_ln2), scale);
+    });
+    return results;
+}
+
+std::vector<fraction> fraction::root_batch(std::span<const fraction> values, size_t degree, fraction const& epsilon,
+                                           size_t threads) {
+    if (degree <= 0) throw std::invalid_argument("Degree must be positive");
+    for (auto const& value: values) {
+        if (value._numerator < 0 && degree % 2 == 0)
+            throw std::domain_error("Even root of negative number");
+    }
+
+    std::vector<fraction> results(values.size());
+    parallel_for(values.size(), threads, [&](size_t i) {
+        results[i] = values[i].root(degree, epsilon);
+    });
+    return results;
 }
 
 fraction fraction::lg(fraction const& epsilon) const {
     if (_numerator <= 0 || _denominator <= 0)
         throw std::domain_error("Base-10 logarithm of non-positive number");
-    return ln(epsilon) / fraction(10, 1).ln(epsilon);
+
+    size_t scale = precision_bits(epsilon) + 1;
+    return from_fixed(log_fixed(_numerator, _denominator, 10, scale), scale);
 }
\ No newline at end of file
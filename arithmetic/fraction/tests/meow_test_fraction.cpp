@@ -677,6 +677,174 @@ TEST(logariphmTests, log10)
     logger->debug(a.to_string() + "  " + " = " + c.to_string());
 }
 
+TEST(normalizationTests, lazy)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>{
+        {"bigint_logs.txt", logger::severity::information},
+    });
+
+    fraction eager;
+    fraction lazy;
+    lazy.set_normalization(fraction::normalization::lazy);
+
+    for (int i = 1; i <= 300; ++i)
+    {
+        const fraction term(big_int(1), big_int(i * (i + 1)));
+        eager += term;
+        lazy += term;
+    }
+
+    // 1/(1*2) + ... + 1/(300*301) = 300/301
+    EXPECT_TRUE(lazy == eager);
+    EXPECT_TRUE(lazy <= eager && lazy >= eager);
+    EXPECT_TRUE(lazy.to_string() == "300/301");
+    EXPECT_TRUE(eager.to_string() == "300/301");
+
+    lazy.set_normalization(fraction::normalization::eager);
+    EXPECT_TRUE(lazy.get_normalization() == fraction::normalization::eager);
+    EXPECT_TRUE(lazy * fraction(big_int(301), big_int(-600)) == fraction(big_int(-1), big_int(2)));
+    logger->debug(lazy.to_string());
+}
+
+TEST(normalizationTests, crossCancel)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>{
+        {"bigint_logs.txt", logger::severity::information},
+    });
+
+    const fraction a(big_int(14), big_int(15));
+    const fraction b(big_int(-25), big_int(21));
+    EXPECT_TRUE((a * b).to_string() == "-10/9");
+    EXPECT_TRUE((a / b).to_string() == "-98/125");
+    EXPECT_TRUE((a + b).to_string() == "-9/35");
+    EXPECT_TRUE((a - a).to_string() == "0/1");
+    logger->debug((a * b).to_string());
+}
+
+TEST(comparisonTests, staged)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>{
+        {"bigint_logs.txt", logger::severity::information},
+    });
+
+    for (int a = -6; a <= 6; ++a) {
+        for (int b = 1; b <= 6; ++b) {
+            for (int c = -6; c <= 6; ++c) {
+                for (int d = 1; d <= 6; ++d) {
+                    auto order = fraction(big_int(a), big_int(b)) <=> fraction(big_int(c), big_int(d));
+                    EXPECT_TRUE(order == (a * d <=> c * b));
+                }
+            }
+        }
+    }
+
+    // neighbouring convergents of golden ratio agree in all continued fraction terms but last
+    big_int f0 = 1, f1 = 1, f2 = 2;
+    for (int i = 0; i < 300; ++i) {
+        f0 = f1;
+        f1 = f2;
+        f2 = f0 + f1;
+    }
+    fraction lower(f1, f0), upper(f2, f1);
+    if (lower > upper) std::swap(lower, upper);
+    EXPECT_TRUE(lower < upper);
+    EXPECT_TRUE(-upper < -lower);
+
+    fraction huge(1_bi << 5000, big_int(3));
+    fraction tiny(big_int(1), 1_bi << 5000);
+    EXPECT_TRUE(tiny < huge);
+    EXPECT_TRUE(-huge < -tiny);
+    EXPECT_TRUE(-huge < tiny);
+
+    fraction lazy(big_int(1), big_int(3));
+    lazy.set_normalization(fraction::normalization::lazy);
+    lazy *= fraction(big_int(7), big_int(7));
+    EXPECT_TRUE((lazy <=> fraction(big_int(2), big_int(6))) == std::partial_ordering::equivalent);
+    logger->debug(lazy.to_string());
+}
+
+TEST(seriesTests, highPrecision)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>{
+        {"bigint_logs.txt", logger::severity::information},
+    });
+
+    const fraction epsilon(1_bi, 1_bi << 1000);
+    const fraction tolerance = epsilon * fraction(4, 1);
+    const fraction one(1, 1);
+
+    for (const fraction &x: {fraction(7, 13), fraction(-1000, 3), fraction(1, 1_bi << 200)})
+    {
+        const auto s = x.sin(epsilon);
+        const auto c = x.cos(epsilon);
+        EXPECT_TRUE(abs(s * s + c * c - one) <= tolerance) << x;
+    }
+
+    const auto ln2 = fraction(2, 1).ln(epsilon);
+    EXPECT_TRUE(abs(fraction(1, 8).ln(epsilon) + ln2 * fraction(3, 1)) <= tolerance);
+
+    const auto quarter_pi = one.arctg(epsilon);
+    EXPECT_TRUE(abs(one.arcsin(epsilon) - quarter_pi * fraction(2, 1)) <= tolerance);
+    EXPECT_TRUE(abs(fraction(-3, 7).arctg(epsilon) + fraction(-7, 3).arctg(epsilon) + quarter_pi * fraction(2, 1))
+                <= tolerance);
+    EXPECT_TRUE(abs(fraction(3, 5).arcsin(epsilon) + fraction(3, 5).arccos(epsilon) - quarter_pi * fraction(2, 1))
+                <= tolerance);
+    logger->debug(ln2.to_string());
+}
+
+TEST(rootTests, highPrecision)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>{
+        {"bigint_logs.txt", logger::severity::information},
+    });
+
+    const fraction epsilon(1_bi, 1_bi << 2000);
+    const auto root2 = fraction(2, 1).root(2, epsilon);
+    EXPECT_TRUE(abs(root2 * root2 - fraction(2, 1)) <= epsilon * fraction(3, 1));
+
+    const auto fifth = fraction(-243, 16807).root(5, epsilon);
+    EXPECT_TRUE(abs(fifth - fraction(-3, 7)) <= epsilon);
+
+    const auto log = fraction(1_bi << 100, 3_bi).log2(epsilon) + fraction(3, 1).log2(epsilon);
+    EXPECT_TRUE(abs(log - fraction(100, 1)) <= epsilon * fraction(2, 1));
+    EXPECT_TRUE(abs(fraction(1000, 1).lg(epsilon) - fraction(3, 1)) <= epsilon);
+    logger->debug(root2.to_string());
+}
+
+TEST(batchTests, sameAsScalar)
+{
+    logger *logger = create_logger(std::vector<std::pair<std::string, logger::severity>>{
+        {"bigint_logs.txt", logger::severity::information},
+    });
+
+    std::vector<fraction> values;
+    for (int i = 1; i <= 40; ++i)
+    {
+        values.emplace_back(big_int(i * i * i + 7), big_int(3 * i + 1));
+    }
+    values.emplace_back(1_bi << 300, 1_bi);
+
+    const fraction epsilon(1_bi, 1_bi << 300);
+    for (size_t threads: {size_t(1), size_t(4), size_t(0)})
+    {
+        const auto logs = fraction::ln_batch(values, epsilon, threads);
+        const auto roots = fraction::root_batch(values, 3, epsilon, threads);
+        ASSERT_EQ(logs.size(), values.size());
+        ASSERT_EQ(roots.size(), values.size());
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            EXPECT_TRUE(logs[i] == values[i].ln(epsilon));
+            EXPECT_TRUE(roots[i] == values[i].root(3, epsilon));
+        }
+    }
+
+    EXPECT_TRUE(fraction::ln_batch(std::vector<fraction>{}).empty());
+    values.emplace_back(-1, 2);
+    EXPECT_THROW(fraction::ln_batch(values), std::domain_error);
+    EXPECT_THROW(fraction::root_batch(values, 2), std::domain_error);
+    logger->debug(values.front().to_string());
+}
+
 auto main(int argc, char **argv) -> int
 {
     testing::InitGoogleTest(&argc, argv);
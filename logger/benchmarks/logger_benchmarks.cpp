@@ -0,0 +1,184 @@
+// Throughput and call latency of loggers, one JSON object per scenario on stdout:
+// logger_benchmarks [messages = 100000] [server = http://127.0.0.1:9200]
+// server scenarios need serv_test running, they are reported as skipped otherwise
+
+#include <client_logger.h>
+#include <client_logger_builder.h>
+#include <server_logger.h>
+#include <server_logger_builder.h>
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+namespace {
+    using clock_type = std::chrono::steady_clock;
+
+    class null_buffer final : public std::streambuf {
+    protected:
+        int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+
+        std::streamsize xsputn(const char *, std::streamsize n) override { return n; }
+    };
+
+    struct scenario_result {
+        size_t messages = 0;
+        double seconds = 0;
+        std::vector<double> latencies_ns;
+    };
+
+    double percentile(std::vector<double> &values, double p) {
+        if (values.empty()) return 0;
+
+        auto index = static_cast<size_t>(p * static_cast<double>(values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(index), values.end());
+        return values[index];
+    }
+
+    void report(const std::string &name, const std::string &format, size_t threads, scenario_result &result) {
+        nlohmann::json js = {
+                {"scenario", name},
+                {"format", format},
+                {"threads", threads},
+                {"messages", result.messages},
+                {"seconds", result.seconds},
+                {"messages_per_second", static_cast<double>(result.messages) / result.seconds},
+                {"p50_ns", percentile(result.latencies_ns, 0.5)},
+                {"p99_ns", percentile(result.latencies_ns, 0.99)},
+                {"max_ns", result.latencies_ns.empty() ? 0 : *std::max_element(result.latencies_ns.begin(), result.latencies_ns.end())}};
+        std::cout << js.dump() << std::endl;
+    }
+
+    // every thread gets own logger from make_logger and logs messages / threads times,
+    // time includes destruction of loggers, so buffered sinks are accounted for
+    scenario_result run(const std::function<std::unique_ptr<logger>()> &make_logger, size_t messages, size_t threads) {
+        const std::string message = "benchmark message with some payload 0123456789";
+        size_t per_thread = messages / threads;
+
+        std::vector<std::unique_ptr<logger>> loggers;
+        for (size_t i = 0; i < threads; ++i) {
+            loggers.push_back(make_logger());
+        }
+
+        std::vector<std::vector<double>> latencies(threads);
+        auto routine = [&](size_t index) {
+            auto &log = *loggers[index];
+            auto &lat = latencies[index];
+            lat.reserve(per_thread);
+
+            for (size_t i = 0; i < per_thread; ++i) {
+                auto begin = clock_type::now();
+                log.information(message);
+                lat.push_back(std::chrono::duration<double, std::nano>(clock_type::now() - begin).count());
+            }
+        };
+
+        auto begin = clock_type::now();
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back(routine, i);
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+        loggers.clear();
+
+        scenario_result result;
+        result.seconds = std::chrono::duration<double>(clock_type::now() - begin).count();
+        result.messages = per_thread * threads;
+        for (auto &lat: latencies) {
+            result.latencies_ns.insert(result.latencies_ns.end(), lat.begin(), lat.end());
+        }
+        return result;
+    }
+
+    std::function<std::unique_ptr<logger>()> client_factory(const std::function<void(client_logger_builder &)> &setup,
+                                                            const std::string &format) {
+        return [=]() {
+            client_logger_builder builder;
+            setup(builder);
+            builder.set_format(format);
+            return std::unique_ptr<logger>(builder.build());
+        };
+    }
+}
+
+int main(int argc, char *argv[]) {
+    size_t messages = argc > 1 ? std::stoul(argv[1]) : 100000;
+    std::string destination = argc > 2 ? argv[2] : "http://127.0.0.1:9200";
+
+    const std::vector<std::string> formats = {"%m", "[%s] %m", "[%d %t][%s] %m"};
+    const size_t threads = std::max(2u, std::min(4u, std::thread::hardware_concurrency()));
+
+    auto console = [](client_logger_builder &builder) {
+        builder.add_console_stream(logger::severity::information);
+    };
+    auto file = [](client_logger_builder &builder) {
+        builder.add_file_stream("bench_single.txt", logger::severity::information);
+    };
+    auto shared_files = [](client_logger_builder &builder) {
+        for (size_t i = 0; i < 4; ++i) {
+            builder.add_file_stream("bench_shared_" + std::to_string(i) + ".txt", logger::severity::information);
+        }
+    };
+    auto binary = [](client_logger_builder &builder) {
+        builder.add_binary_file_stream("bench_binary.bin", logger::severity::information);
+    };
+
+    for (auto &format: formats) {
+        {
+            // console output goes to null buffer, only formatting and synchronization are measured
+            null_buffer sink;
+            auto *old_buffer = std::cout.rdbuf(&sink);
+            auto result = run(client_factory(console, format), messages, 1);
+            std::cout.rdbuf(old_buffer);
+            report("client_console", format, 1, result);
+        }
+
+        auto single = run(client_factory(file, format), messages, 1);
+        report("client_file", format, 1, single);
+
+        auto shared = run(client_factory(shared_files, format), messages, threads);
+        report("client_shared_files", format, threads, shared);
+    }
+
+    // binary sink stores raw fields and ignores format string, so it runs once
+    auto binary_result = run(client_factory(binary, "%m"), messages, 1);
+    report("client_binary_file", "binary", 1, binary_result);
+
+    for (auto &path: {"bench_single.txt", "bench_shared_0.txt", "bench_shared_1.txt", "bench_shared_2.txt",
+                      "bench_shared_3.txt", "bench_binary.bin"}) {
+        std::filesystem::remove(path);
+    }
+
+    httplib::Client probe(destination);
+    probe.set_connection_timeout(1);
+    if (!probe.Get("/")) {
+        std::cout << nlohmann::json{{"scenario", "server"}, {"skipped", true}, {"destination", destination}}.dump() << std::endl;
+        return 0;
+    }
+
+    for (auto &format: formats) {
+        auto factory = [&]() {
+            server_logger_builder builder;
+            builder.set_destination(destination);
+            builder.add_file_stream("bench_server.txt", logger::severity::information);
+            builder.set_format(format);
+            return std::unique_ptr<logger>(builder.build());
+        };
+
+        auto result = run(factory, messages, 1);
+        report("server", format, 1, result);
+    }
+
+    return 0;
+}
@@ -0,0 +1,43 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_BINARY_LOG_RECORD_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_BINARY_LOG_RECORD_H
+
+#include <logger.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/** Binary log file: file header followed by records, fields are in native byte order
+ *
+ *  file header: "MPOSBLOG" (8 bytes), version (uint32)
+ *  record:      timestamp (uint64, ns since epoch), severity (uint8), thread id (uint64),
+ *               payload length (uint32), payload
+ */
+namespace binary_log {
+    constexpr std::string_view file_magic = "MPOSBLOG";
+
+    constexpr uint32_t file_version = 1;
+
+    constexpr size_t file_header_size = file_magic.size() + sizeof(uint32_t);
+
+    constexpr size_t record_header_size = sizeof(uint64_t) + sizeof(uint8_t) + sizeof(uint64_t) + sizeof(uint32_t);
+
+    struct record {
+        uint64_t timestamp;
+        logger::severity severity;
+        uint64_t thread_id;
+        std::string payload;
+    };
+
+    void append_file_header(std::string &block);
+
+    void append_record(std::string &block, uint64_t timestamp, logger::severity severity, uint64_t thread_id,
+                       std::string_view payload);
+
+    //returns false if stream doesn't start with file header
+    bool read_file_header(std::istream &stream);
+
+    //returns false at the end of stream or on truncated record
+    bool read_record(std::istream &stream, record &result);
+}
+
+#endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_BINARY_LOG_RECORD_H
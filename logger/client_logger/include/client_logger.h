@@ -2,28 +2,100 @@
 #define MATH_PRACTICE_AND_OPERATING_SYSTEMS_CLIENT_LOGGER_H
 
 #include <logger.h>
+#include <log_throttle.h>
+#include "mapped_file.h"
 #include <array>
 #include <unordered_map>
 #include <forward_list>
+#include <list>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <string_view>
 
 class client_logger_builder;
 
 class client_logger final :
         public logger {
+public:
+    /** File is moved to path.1 (path.1 to path.2 and so on, up to path.max_files) and reopened
+     *  when line doesn't fit into max_bytes or when local day changes
+     */
+    struct rotation_policy {
+        size_t max_bytes = 0;// 0 - no size limit
+        bool daily = false;
+        size_t max_files = 5;
+
+        bool enabled() const noexcept { return max_bytes != 0 || daily; }
+    };
+
 private:
     //region refcounted_stream
 
     class refcounted_stream final {
-        static std::unordered_map<std::string, std::pair<size_t, std::ofstream> > _global_streams;
-
-        std::pair<std::string, std::ofstream *> _stream;
+        /** File taken out of shared_file by rotation, it is closed and renamed to path.1 after mut is released
+         */
+        struct retired_file {
+            std::ofstream stream;
+            mapped_file mapping;
+            std::string staged_path;
+            size_t max_files = 0;
+        };
+
+        /** Opened file shared by all refcounted_streams with same path, rotated by whoever writes to it.
+         *  Lines are written whole under mut, so concurrent loggers don't interleave inside a line.
+         *  Under mut rotation only renames file aside and reopens path, closing and shifting of
+         *  path.1, path.2, ... is done by rotating thread after mut is released.
+         *  Mapped file is written through mapping instead of stream
+         */
+        struct shared_file {
+            size_t refcount;// guarded by _global_streams_mut
+            std::mutex mut;
+            bool mapped;
+            std::ofstream stream;
+            mapped_file mapping;
+            rotation_policy policy;
+            size_t written;
+            std::time_t next_rotation;
+            size_t rotations;
+
+            // in rotation order, guarded by retired_mut; rotation_mut keeps renames of different rotations apart
+            std::list<retired_file> retired;
+            std::mutex retired_mut;
+            std::mutex rotation_mut;
+
+            shared_file(const std::string &path, const rotation_policy &policy, bool mapped);
+
+            bool is_open() const noexcept;
+
+            void close() noexcept;
+
+            void write_line(const std::string &path, std::string_view line);
+
+            //called under mut: moves file aside to staged path and reopens path
+            void retire(const std::string &path);
+
+            //called without mut: closes retired files and shifts backups in rotation order
+            void finish_rotations(const std::string &path);
+        };
+
+        static std::unordered_map<std::string, shared_file> _global_streams;
+        static std::mutex _global_streams_mut;
+
+        std::pair<std::string, shared_file *> _stream;
         friend client_logger;
         friend client_logger_builder;
 
+        //decrements refcount, file is closed by last owner
+        void release() noexcept;
+
     public:
         explicit refcounted_stream(const std::string &path);
 
+        //policy is applied if file isn't opened yet or has no rotation,
+        //mapped is ignored if file is already opened
+        refcounted_stream(const std::string &path, const rotation_policy &policy, bool mapped = false);
+
         refcounted_stream(const refcounted_stream &oth);
 
         refcounted_stream &operator=(const refcounted_stream &oth);
@@ -40,25 +112,79 @@ private:
 
     //region refcounted_stream
 
+    //region binary_stream
+
+    /** Appends binary records (see binary_log_record.h) to file in blocks of block_size bytes,
+     *  one instance per path is shared between all loggers
+     */
+    class binary_stream final {
+        static std::unordered_map<std::string, std::weak_ptr<binary_stream> > _global_binary_streams;
+        static std::mutex _global_binary_streams_mut;
+
+        static constexpr size_t block_size = 64 * 1024;
+
+        std::string _path;
+        std::mutex _mut;
+        std::ofstream _stream;
+        std::string _block;
+
+        void flush_block();
+
+    public:
+        explicit binary_stream(const std::string &path);
+
+        binary_stream(const binary_stream &oth) = delete;
+
+        binary_stream &operator=(const binary_stream &oth) = delete;
+
+        static std::shared_ptr<binary_stream> open(const std::string &path);
+
+        void write(logger::severity severity, std::string_view message);
+
+        ~binary_stream();
+    };
+
+    //endregion binary_stream
+
     enum class flag { DATE, TIME, SEVERITY, MESSAGE, NO_FLAG };
 
+    static std::mutex _console_mut;
+
 private:
     std::unordered_map<logger::severity, std::pair<std::forward_list<refcounted_stream>, bool> > _output_streams;
 
+    std::unordered_map<logger::severity, std::forward_list<std::shared_ptr<binary_stream> > > _binary_streams;
+
     std::string _format;
 
+    //shared between copies, nullptr if nothing is throttled
+    std::shared_ptr<log_throttle> _throttle;
+
 private:
     //opens all streams
     client_logger(
             const std::unordered_map<logger::severity, std::pair<std::forward_list<refcounted_stream>, bool> > &streams,
-            std::string format);
+            const std::unordered_map<logger::severity, std::forward_list<std::shared_ptr<binary_stream> > > &binary_streams,
+            std::string format,
+            std::shared_ptr<log_throttle> throttle);
 
-    std::string make_format(const std::string &message, severity sev) const;
+    //writes to all streams of severity without throttling
+    void write(std::string_view message, severity sev);
 
     static flag char_to_flag(char c) noexcept;
 
     friend client_logger_builder;
 
+public:
+    /** Renders message with format flags %d %t %s %m as if it was logged at time
+     */
+    static std::string format_record(const std::string &format, std::string_view message, severity sev,
+                                     std::time_t time);
+
+    //same as format_record, but appends to out
+    static void append_record(std::string &out, const std::string &format, std::string_view message, severity sev,
+                              std::time_t time);
+
 public:
     client_logger(client_logger const &other);
 
@@ -71,8 +197,10 @@ public:
     ~client_logger() noexcept final;
 
 public:
+    using logger::log;
+
     [[nodiscard]] logger &log(
-            const std::string &message,
+            std::string_view message,
             logger::severity severity) & override;
 };
 
@@ -13,12 +13,19 @@ private:
     std::unordered_map<logger::severity, std::pair<std::forward_list<client_logger::refcounted_stream>, bool> >
             _output_streams;
 
+    std::unordered_map<logger::severity, std::forward_list<std::shared_ptr<client_logger::binary_stream> > >
+            _binary_streams;
+
     std::string _format;
 
-    void parse_severity(logger::severity, nlohmann::json &j);
+    std::unordered_map<logger::severity, log_throttle::rule> _throttle_rules;
+
+    std::chrono::milliseconds _throttle_report_interval;
+
+    void parse_severity(logger::severity, nlohmann::json &j, client_logger::rotation_policy const &rotation);
 
 public:
-    client_logger_builder() : _format("%m") {
+    client_logger_builder() : _format("%m"), _throttle_report_interval(std::chrono::seconds(10)) {
     };
 
     client_logger_builder(
@@ -40,9 +47,31 @@ public:
             std::string const &stream_file_path,
             logger::severity severity) & override;
 
+    client_logger_builder &add_file_stream(
+            std::string const &stream_file_path,
+            logger::severity severity,
+            client_logger::rotation_policy const &rotation) &;
+
+    /** Lines are written through memory mapping of file preallocated in mapped_file::chunk_size chunks,
+     *  file is truncated to written length when last logger using it is destroyed
+     */
+    client_logger_builder &add_mapped_file_stream(
+            std::string const &stream_file_path,
+            logger::severity severity,
+            client_logger::rotation_policy const &rotation = client_logger::rotation_policy()) &;
+
     logger_builder &add_console_stream(
             logger::severity severity) & override;
 
+    /** Records go to file unformatted, use mp_os_lggr_bnr_dcdr to render them with format
+     */
+    client_logger_builder &add_binary_file_stream(
+            std::string const &stream_file_path,
+            logger::severity severity) &;
+
+    /** Throttle rules are read from "throttle" object keyed by severity name, the same way server_logger_builder does,
+     *  so one configuration fragment throttles both loggers
+     */
     logger_builder &transform_with_configuration(
             std::string const &configuration_file_path,
             std::string const &configuration_path) & override;
@@ -51,6 +80,13 @@ public:
 
     logger_builder &set_destination(const std::string &format) & override;
 
+    client_logger_builder &set_throttle(
+            logger::severity severity,
+            log_throttle::rule const &rule) &;
+
+    client_logger_builder &set_throttle_report_interval(
+            std::chrono::milliseconds interval) &;
+
     logger_builder &clear() & override;
 
     [[nodiscard]] logger *build() const override;
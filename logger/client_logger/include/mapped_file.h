@@ -0,0 +1,54 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_MAPPED_FILE_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_MAPPED_FILE_H
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+/** Append-only file written through memory mapping: file is preallocated in chunks of chunk_size,
+ *  every write is a memcpy into mapped region and pages are flushed by the kernel.
+ *  close() truncates file to the length actually written, if process dies before that
+ *  file keeps zero-filled tail up to the end of current chunk.
+ *  Without mmap (Windows) falls back to std::ofstream
+ */
+class mapped_file final {
+public:
+    static constexpr size_t chunk_size = 16 * 1024 * 1024;
+
+private:
+#ifdef _WIN32
+    std::ofstream _stream;
+#else
+    int _fd;
+    char *_data;
+    size_t _capacity;
+    size_t _size;
+
+    //remaps file so that it has at least required bytes, current mapping is kept on failure
+    bool reserve(size_t required);
+#endif
+
+public:
+    mapped_file() noexcept;
+
+    mapped_file(const mapped_file &) = delete;
+
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    //existing content is kept unless truncate is set
+    bool open(const std::string &path, bool truncate);
+
+    bool is_open() const noexcept;
+
+    //throws std::ios_base::failure if file is not open or can't be grown, file stays open after failed grow
+    void write(std::string_view data);
+
+    void close() noexcept;
+
+    void swap(mapped_file &other) noexcept;
+
+    ~mapped_file();
+};
+
+#endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_MAPPED_FILE_H
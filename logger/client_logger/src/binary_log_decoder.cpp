@@ -0,0 +1,34 @@
+#include <iostream>
+#include <fstream>
+#include "../include/binary_log_record.h"
+#include "../include/client_logger.h"
+
+// renders binary log written by client_logger as text:
+// mp_os_lggr_bnr_dcdr <binary log path> [format = "%d %t %s %m"]
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <binary log path> [format]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream stream(argv[1], std::ios_base::binary);
+    if (!stream.is_open()) {
+        std::cerr << "Can't open file " << argv[1] << std::endl;
+        return 1;
+    }
+
+    const std::string format = argc > 2 ? argv[2] : "%d %t %s %m";
+
+    if (!binary_log::read_file_header(stream)) {
+        std::cerr << argv[1] << " is not a binary log" << std::endl;
+        return 1;
+    }
+
+    binary_log::record record;
+    while (binary_log::read_record(stream, record)) {
+        auto time = static_cast<std::time_t>(record.timestamp / 1000000000);
+        std::cout << client_logger::format_record(format, record.payload, record.severity, time) << '\n';
+    }
+
+    return stream.eof() ? 0 : 1;
+}
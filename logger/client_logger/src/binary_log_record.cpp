@@ -0,0 +1,61 @@
+#include <cstring>
+#include <istream>
+#include "../include/binary_log_record.h"
+
+namespace {
+    template<typename T>
+    void append_value(std::string &block, T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        block.append(bytes, sizeof(T));
+    }
+
+    template<typename T>
+    T read_value(const char *bytes) {
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        return value;
+    }
+}
+
+void binary_log::append_file_header(std::string &block) {
+    block.append(file_magic);
+    append_value(block, file_version);
+}
+
+void binary_log::append_record(std::string &block, uint64_t timestamp, logger::severity severity, uint64_t thread_id,
+                               std::string_view payload) {
+    append_value(block, timestamp);
+    append_value(block, static_cast<uint8_t>(severity));
+    append_value(block, thread_id);
+    append_value(block, static_cast<uint32_t>(payload.size()));
+    block.append(payload);
+}
+
+bool binary_log::read_file_header(std::istream &stream) {
+    char header[file_header_size];
+    if (!stream.read(header, file_header_size)) {
+        return false;
+    }
+
+    return std::string_view(header, file_magic.size()) == file_magic &&
+           read_value<uint32_t>(header + file_magic.size()) == file_version;
+}
+
+bool binary_log::read_record(std::istream &stream, binary_log::record &result) {
+    char header[record_header_size];
+    if (!stream.read(header, record_header_size)) {
+        return false;
+    }
+
+    const char *position = header;
+    result.timestamp = read_value<uint64_t>(position);
+    position += sizeof(uint64_t);
+    result.severity = static_cast<logger::severity>(read_value<uint8_t>(position));
+    position += sizeof(uint8_t);
+    result.thread_id = read_value<uint64_t>(position);
+    position += sizeof(uint64_t);
+
+    result.payload.resize(read_value<uint32_t>(position));
+    return static_cast<bool>(stream.read(result.payload.data(), static_cast<std::streamsize>(result.payload.size())));
+}
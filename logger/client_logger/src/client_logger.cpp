@@ -2,9 +2,22 @@
 #include <sstream>
 #include <algorithm>
 #include <utility>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <thread>
 #include "../include/client_logger.h"
+#include "../include/binary_log_record.h"
 
-std::unordered_map<std::string, std::pair<size_t, std::ofstream> > client_logger::refcounted_stream::_global_streams;
+std::unordered_map<std::string, client_logger::refcounted_stream::shared_file> client_logger::refcounted_stream::_global_streams;
+
+std::mutex client_logger::refcounted_stream::_global_streams_mut;
+
+std::unordered_map<std::string, std::weak_ptr<client_logger::binary_stream> > client_logger::binary_stream::_global_binary_streams;
+
+std::mutex client_logger::binary_stream::_global_binary_streams_mut;
+
+std::mutex client_logger::_console_mut;
 
 
 client_logger::flag client_logger::char_to_flag(char c) noexcept {
@@ -22,73 +35,113 @@ client_logger::flag client_logger::char_to_flag(char c) noexcept {
     }
 }
 
-std::string client_logger::make_format(const std::string &message, const severity sev) const {
-    std::ostringstream oss;
+std::string client_logger::format_record(const std::string &format, std::string_view message, severity sev,
+                                         std::time_t time) {
+    std::string result;
+    append_record(result, format, message, sev, time);
+    return result;
+}
 
-    for (auto elem = _format.begin(), end = _format.end(); elem != end; ++elem) {
+void client_logger::append_record(std::string &out, const std::string &format, std::string_view message,
+                                  severity sev, std::time_t time) {
+    for (auto elem = format.begin(), end = format.end(); elem != end; ++elem) {
         flag type = flag::NO_FLAG;
-        if (*elem == '%') type = char_to_flag(*(elem + 1));
+        if (*elem == '%' && elem + 1 != end) type = char_to_flag(*(elem + 1));
 
         if (type != flag::NO_FLAG) {
             switch (type) {
                 case flag::DATE:
-                    oss << current_date_to_string();
+                    append_date(out, time);
                     break;
                 case flag::TIME:
-                    oss << current_time_to_string();
+                    append_time(out, time);
                     break;
                 case flag::SEVERITY:
-                    oss << severity_to_string(sev);
+                    out += severity_to_string(sev);
                     break;
                 default:
-                    oss << message;
+                    out += message;
                     break;
             }
             ++elem;
         } else {
-            oss << *elem;
+            out += *elem;
         }
     }
-    return oss.str();
 }
 
-logger &client_logger::log(const std::string &message, const logger::severity severity) & {
-    const std::string output = make_format(message, severity);
+logger &client_logger::log(std::string_view message, const logger::severity severity) & {
+    if (_throttle != nullptr) {
+        size_t suppressed = 0;
+        bool admitted = _throttle->admit(severity, suppressed);
+
+        if (suppressed != 0) {
+            write(log_throttle::report_message(suppressed), severity);
+        }
+        if (!admitted) {
+            return *this;
+        }
+    }
+
+    write(message, severity);
+    return *this;
+}
+
+void client_logger::write(std::string_view message, const logger::severity severity) {
+    auto binary_streams = _binary_streams.find(severity);
+    if (binary_streams != _binary_streams.end()) {
+        for (auto &stream: binary_streams->second) {
+            stream->write(severity, message);
+        }
+    }
 
     auto opened_stream = _output_streams.find(severity);
     if (opened_stream == _output_streams.end()) {
-        return *this;
+        return;
     }
+
+    // reused between calls, so line is formatted without allocation once buffer has grown
+    thread_local std::string output;
+    output.clear();
+    append_record(output, _format, message, severity, std::time(nullptr));
+
     if (opened_stream->second.second) {
+        std::lock_guard lock(_console_mut);
         std::cout << output << std::endl;
     }
 
     for (auto &stream: opened_stream->second.first) {
-        std::ofstream *ofstr = stream._stream.second;
-        if (ofstr != NULL) {
-            *ofstr << output << std::endl;
+        auto *file = stream._stream.second;
+        if (file != nullptr) {
+            file->write_line(stream._stream.first, output);
         }
     }
-    return *this;
 }
 
 
 client_logger::client_logger(
         const std::unordered_map<logger::severity, std::pair<std::forward_list<refcounted_stream>, bool> > &streams,
-        std::string format)
-        : _output_streams(streams), _format(std::move(format)) {
+        const std::unordered_map<logger::severity, std::forward_list<std::shared_ptr<binary_stream> > > &binary_streams,
+        std::string format,
+        std::shared_ptr<log_throttle> throttle)
+        : _output_streams(streams), _binary_streams(binary_streams), _format(std::move(format)),
+          _throttle(std::move(throttle)) {
 }
 
 
 client_logger::client_logger(const client_logger &other) : _output_streams(other._output_streams),
-                                                           _format(other._format) {
+                                                           _binary_streams(other._binary_streams),
+                                                           _format(other._format),
+                                                           _throttle(other._throttle) {
 }
 
 
 client_logger &client_logger::operator=(const client_logger &other) {
     if (this != &other) {
         _output_streams = other._output_streams;
+        _binary_streams = other._binary_streams;
         _format = other._format;
+        _throttle = other._throttle;
     }
     return *this;
 }
@@ -96,80 +149,240 @@ client_logger &client_logger::operator=(const client_logger &other) {
 
 client_logger::client_logger(client_logger &&other) noexcept
         : _output_streams(std::move(other._output_streams)),
-          _format(std::move(other._format)) {
+          _binary_streams(std::move(other._binary_streams)),
+          _format(std::move(other._format)),
+          _throttle(std::move(other._throttle)) {
 }
 
 client_logger &client_logger::operator=(client_logger &&other) noexcept {
     if (this != &other) {
         _output_streams = std::move(other._output_streams);
+        _binary_streams = std::move(other._binary_streams);
         _format = std::move(other._format);
+        _throttle = std::move(other._throttle);
     }
     return *this;
 }
 
-client_logger::~client_logger() noexcept = default;
+client_logger::~client_logger() noexcept {
+    if (_throttle == nullptr || _throttle.use_count() != 1) {
+        return;
+    }
 
-client_logger::refcounted_stream::refcounted_stream(const std::string &path) {
+    try {
+        for (auto &[severity, suppressed]: _throttle->take_suppressed()) {
+            write(log_throttle::report_message(suppressed), severity);
+        }
+    } catch (...) {
+    }
+}
+
+namespace {
+    std::time_t next_local_midnight(std::time_t now) {
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &now);
+#else
+        localtime_r(&now, &local);
+#endif
+        local.tm_mday += 1;
+        local.tm_hour = local.tm_min = local.tm_sec = 0;
+        local.tm_isdst = -1;
+        return std::mktime(&local);
+    }
+}
+
+client_logger::refcounted_stream::shared_file::shared_file(const std::string &path, const rotation_policy &policy,
+                                                          bool mapped)
+        : refcount(1), mapped(mapped), policy(policy), written(0),
+          next_rotation(next_local_midnight(std::time(nullptr))), rotations(0) {
+    if (mapped) {
+        mapping.open(path, true);
+    } else {
+        stream.open(path);
+    }
+}
+
+bool client_logger::refcounted_stream::shared_file::is_open() const noexcept {
+    return mapped ? mapping.is_open() : stream.is_open();
+}
+
+void client_logger::refcounted_stream::shared_file::close() noexcept {
+    if (mapped) {
+        mapping.close();
+    } else {
+        stream.close();
+    }
+}
+
+void client_logger::refcounted_stream::shared_file::write_line(const std::string &path, std::string_view line) {
+    bool rotated = false;
+    {
+        std::lock_guard lock(mut);
+
+        if (policy.enabled()) {
+            bool is_full = policy.max_bytes != 0 && written != 0 && written + line.size() + 1 > policy.max_bytes;
+            bool is_new_day = policy.daily && std::time(nullptr) >= next_rotation;
+
+            if (is_full || is_new_day) {
+                retire(path);
+                rotated = true;
+            }
+        }
+
+        if (mapped) {
+            mapping.write(line);
+            mapping.write("\n");
+        } else {
+            stream << line << std::endl;
+        }
+        written += line.size() + 1;
+    }
+
+    if (rotated) {
+        finish_rotations(path);
+    }
+}
+
+void client_logger::refcounted_stream::shared_file::retire(const std::string &path) {
+    std::list<retired_file> entry(1);
+    retired_file &file = entry.front();
+    file.staged_path = path + ".rotating." + std::to_string(++rotations);
+    file.max_files = policy.max_files;
+
+#ifdef _WIN32
+    // opened file can't be renamed here, so it is closed under mut
+    close();
+#endif
+
+    std::error_code ec;
+    std::filesystem::rename(path, file.staged_path, ec);
+
+    // all refcounted_streams keep pointer to this shared_file, so they continue with reopened stream
+    if (mapped) {
+        file.mapping.swap(mapping);
+        mapping.open(path, true);
+    } else {
+        file.stream.swap(stream);
+        stream.open(path, std::ios_base::trunc);
+    }
+    written = 0;
+    next_rotation = next_local_midnight(std::time(nullptr));
+
+    std::lock_guard lock(retired_mut);
+    retired.splice(retired.end(), entry);
+}
+
+void client_logger::refcounted_stream::shared_file::finish_rotations(const std::string &path) {
+    std::lock_guard rotation_lock(rotation_mut);
+
+    while (true) {
+        std::list<retired_file> entry;
+        {
+            std::lock_guard lock(retired_mut);
+            if (retired.empty()) {
+                return;
+            }
+            entry.splice(entry.begin(), retired, retired.begin());
+        }
+
+        retired_file &file = entry.front();
+        file.stream.close();
+        file.mapping.close();
+
+        std::error_code ec;
+        if (file.max_files == 0) {
+            std::filesystem::remove(file.staged_path, ec);
+        } else {
+            for (size_t i = file.max_files - 1; i > 0; --i) {
+                std::filesystem::rename(path + "." + std::to_string(i), path + "." + std::to_string(i + 1), ec);
+            }
+            std::filesystem::rename(file.staged_path, path + ".1", ec);
+        }
+    }
+}
+
+client_logger::refcounted_stream::refcounted_stream(const std::string &path) : refcounted_stream(path, rotation_policy()) {
+}
+
+client_logger::refcounted_stream::refcounted_stream(const std::string &path, const rotation_policy &policy,
+                                                    bool mapped) {
+    std::lock_guard lock(_global_streams_mut);
     auto opened_stream = _global_streams.find(path);
 
     if (opened_stream == _global_streams.end()) {
-        auto inserted_stream = _global_streams.emplace(path, std::make_pair(1, std::ofstream(path)));
+        auto inserted_stream = _global_streams.try_emplace(path, path, policy, mapped);
 
         auto &stream = inserted_stream.first->second;
 
-        if (!stream.second.is_open()) {
+        if (!stream.is_open()) {
+            _global_streams.erase(inserted_stream.first);
             throw std::ios_base::failure("Can't open file " + path);
         }
 
-        _stream = std::make_pair(path, &inserted_stream.first->second.second);
+        _stream = std::make_pair(path, &stream);
     } else {
-        opened_stream->second.first++;
-        _stream = std::make_pair(path, &opened_stream->second.second);
+        opened_stream->second.refcount++;
+        if (policy.enabled()) {
+            std::lock_guard file_lock(opened_stream->second.mut);
+            if (!opened_stream->second.policy.enabled()) {
+                opened_stream->second.policy = policy;
+            }
+        }
+        _stream = std::make_pair(path, &opened_stream->second);
     }
 }
 
-client_logger::refcounted_stream::refcounted_stream(const client_logger::refcounted_stream &oth) {
+client_logger::refcounted_stream::refcounted_stream(const client_logger::refcounted_stream &oth) : _stream(oth._stream.first, nullptr) {
+    if (oth._stream.second == nullptr) {
+        return;
+    }
+
+    std::lock_guard lock(_global_streams_mut);
     auto opened_stream = _global_streams.find(oth._stream.first);
 
     if (opened_stream != _global_streams.end()) {
-        ++opened_stream->second.first;
-        _stream.second = &opened_stream->second.second;
+        ++opened_stream->second.refcount;
+        _stream.second = &opened_stream->second;
     } else {
-        auto inserted = _global_streams.emplace(_stream.first,
-                                                std::make_pair<size_t>(1, std::ofstream(oth._stream.first)));
-        if (!inserted.second || !inserted.first->second.second.is_open()) {
-            if (inserted.second) {
-                _global_streams.erase(inserted.first);
-            }
+        auto inserted = _global_streams.try_emplace(_stream.first, _stream.first, oth._stream.second->policy,
+                                                    oth._stream.second->mapped);
+        if (!inserted.first->second.is_open()) {
+            _global_streams.erase(inserted.first);
             throw std::ios_base::failure("Can't open file " + oth._stream.first);
         }
-        _stream.second = &inserted.first->second.second;
+        _stream.second = &inserted.first->second;
+    }
+}
+
+void client_logger::refcounted_stream::release() noexcept {
+    if (_stream.second == nullptr) {
+        return;
+    }
+
+    std::lock_guard lock(_global_streams_mut);
+    auto opened_stream = _global_streams.find(_stream.first);
+    if (opened_stream != _global_streams.end()) {
+        --opened_stream->second.refcount;
+        if (opened_stream->second.refcount == 0) {
+            _global_streams.erase(opened_stream);
+        }
     }
+    _stream.second = nullptr;
 }
 
 client_logger::refcounted_stream &
 client_logger::refcounted_stream::operator=(const client_logger::refcounted_stream &oth) {
     if (this == &oth) return *this;
 
-    if (_stream.second != NULL) {
-        auto opened_stream = _global_streams.find(_stream.first);
-
-        if (opened_stream != _global_streams.end()) {
-            --opened_stream->second.first;
-
-            if (opened_stream->second.first == 0) {
-                opened_stream->second.second.close();
-                _global_streams.erase(opened_stream);
-            }
-        }
-    }
+    release();
 
+    std::lock_guard lock(_global_streams_mut);
     _stream.first = oth._stream.first;
     _stream.second = oth._stream.second;
 
-    if (_stream.second != NULL) {
-        auto opened_stream = _global_streams.find(_stream.first);
-        ++opened_stream->second.first;
+    if (_stream.second != nullptr) {
+        ++_stream.second->refcount;
     }
     return *this;
 }
@@ -183,21 +396,67 @@ client_logger::refcounted_stream::refcounted_stream(client_logger::refcounted_st
 client_logger::refcounted_stream &client_logger::refcounted_stream::operator=(
         client_logger::refcounted_stream &&oth) noexcept {
     if (this != &oth) {
+        release();
         _stream = std::move(oth._stream);
-        oth._stream.second = NULL;
+        oth._stream.second = nullptr;
     }
     return *this;
 }
 
 client_logger::refcounted_stream::~refcounted_stream() {
-    if (_stream.second != NULL) {
-        auto opened_stream = _global_streams.find(_stream.first);
-        if (opened_stream != _global_streams.end()) {
-            --opened_stream->second.first;
-            if (opened_stream->second.first == 0) {
-                opened_stream->second.second.close();
-                _global_streams.erase(opened_stream);
-            }
+    release();
+}
+
+client_logger::binary_stream::binary_stream(const std::string &path)
+        : _path(path), _stream(path, std::ios_base::binary | std::ios_base::app) {
+    if (!_stream.is_open()) {
+        throw std::ios_base::failure("Can't open file " + path);
+    }
+
+    _block.reserve(block_size);
+    if (_stream.tellp() == 0) {
+        binary_log::append_file_header(_block);
+    }
+}
+
+std::shared_ptr<client_logger::binary_stream> client_logger::binary_stream::open(const std::string &path) {
+    std::lock_guard lock(_global_binary_streams_mut);
+    auto opened_stream = _global_binary_streams.find(path);
+    if (opened_stream != _global_binary_streams.end()) {
+        if (auto stream = opened_stream->second.lock()) {
+            return stream;
         }
     }
+
+    auto stream = std::make_shared<binary_stream>(path);
+    _global_binary_streams[path] = stream;
+    return stream;
+}
+
+void client_logger::binary_stream::write(logger::severity severity, std::string_view message) {
+    auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    auto thread_id = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+    std::lock_guard lock(_mut);
+    binary_log::append_record(_block, static_cast<uint64_t>(timestamp), severity, thread_id, message);
+    if (_block.size() >= block_size) {
+        flush_block();
+    }
+}
+
+void client_logger::binary_stream::flush_block() {
+    _stream.write(_block.data(), static_cast<std::streamsize>(_block.size()));
+    _stream.flush();
+    _block.clear();
+}
+
+client_logger::binary_stream::~binary_stream() {
+    flush_block();
+
+    std::lock_guard lock(_global_binary_streams_mut);
+    auto opened_stream = _global_binary_streams.find(_path);
+    if (opened_stream != _global_binary_streams.end() && opened_stream->second.expired()) {
+        _global_binary_streams.erase(opened_stream);
+    }
 }
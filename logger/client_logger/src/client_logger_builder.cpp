@@ -5,15 +5,49 @@
 
 using namespace nlohmann;
 
+// weakly_canonical leaves relative path as is while file doesn't exist, so same file could get two keys
+static std::string canonical_path(std::string const &path) {
+    return std::filesystem::weakly_canonical(std::filesystem::absolute(path)).string();
+}
+
+// fields that are absent keep values of policy
+static client_logger::rotation_policy parse_rotation(const json &j, client_logger::rotation_policy policy) {
+    if (!j.is_object()) return policy;
+
+    policy.max_bytes = j.value("max_bytes", policy.max_bytes);
+    policy.daily = j.value("daily", policy.daily);
+    policy.max_files = j.value("max_files", policy.max_files);
+    return policy;
+}
+
 logger_builder &
 client_logger_builder::add_file_stream(std::string const &stream_file_path, logger::severity severity) & {
+    return add_file_stream(stream_file_path, severity, client_logger::rotation_policy());
+}
+
+client_logger_builder &
+client_logger_builder::add_file_stream(std::string const &stream_file_path, logger::severity severity,
+                                       client_logger::rotation_policy const &rotation) & {
     auto opened_stream = _output_streams.find(severity);
     if (opened_stream == _output_streams.end()) {
         opened_stream = _output_streams.emplace(
                 severity, std::make_pair(std::forward_list<client_logger::refcounted_stream>(), false)).first;;
     }
 
-    opened_stream->second.first.emplace_front(std::filesystem::weakly_canonical(stream_file_path).string());
+    opened_stream->second.first.emplace_front(canonical_path(stream_file_path), rotation);
+    return *this;
+}
+
+client_logger_builder &
+client_logger_builder::add_mapped_file_stream(std::string const &stream_file_path, logger::severity severity,
+                                              client_logger::rotation_policy const &rotation) & {
+    auto opened_stream = _output_streams.find(severity);
+    if (opened_stream == _output_streams.end()) {
+        opened_stream = _output_streams.emplace(
+                severity, std::make_pair(std::forward_list<client_logger::refcounted_stream>(), false)).first;
+    }
+
+    opened_stream->second.first.emplace_front(canonical_path(stream_file_path), rotation, true);
     return *this;
 }
 
@@ -28,6 +62,13 @@ logger_builder &client_logger_builder::add_console_stream(logger::severity sever
     return *this;
 }
 
+client_logger_builder &
+client_logger_builder::add_binary_file_stream(std::string const &stream_file_path, logger::severity severity) & {
+    _binary_streams[severity].push_front(
+            client_logger::binary_stream::open(canonical_path(stream_file_path)));
+    return *this;
+}
+
 logger_builder &client_logger_builder::transform_with_configuration(std::string const &configuration_file_path,
                                                                     std::string const &configuration_path) & {
     std::ifstream file(configuration_file_path);
@@ -39,12 +80,34 @@ logger_builder &client_logger_builder::transform_with_configuration(std::string
     auto opened_stream = data.find(configuration_path);
     if (opened_stream == data.end() || !opened_stream->is_object()) return *this;
 
-    parse_severity(logger::severity::information, (*opened_stream)["information"]);
-    parse_severity(logger::severity::critical, (*opened_stream)["critical"]);
-    parse_severity(logger::severity::warning, (*opened_stream)["warning"]);
-    parse_severity(logger::severity::trace, (*opened_stream)["trace"]);
-    parse_severity(logger::severity::debug, (*opened_stream)["debug"]);
-    parse_severity(logger::severity::error, (*opened_stream)["error"]);
+    auto rotation = parse_rotation((*opened_stream)["rotation"], client_logger::rotation_policy());
+
+    parse_severity(logger::severity::information, (*opened_stream)["information"], rotation);
+    parse_severity(logger::severity::critical, (*opened_stream)["critical"], rotation);
+    parse_severity(logger::severity::warning, (*opened_stream)["warning"], rotation);
+    parse_severity(logger::severity::trace, (*opened_stream)["trace"], rotation);
+    parse_severity(logger::severity::debug, (*opened_stream)["debug"], rotation);
+    parse_severity(logger::severity::error, (*opened_stream)["error"], rotation);
+
+    // same schema as server_logger: "throttle": {"TRACE": {"sample": N, "rate_limit": {"rate": ..., "burst": ...}}, ...}
+    auto throttle = opened_stream->find("throttle");
+    if (throttle != opened_stream->end() && throttle->is_object()) {
+        for (auto &[sev, item]: throttle->items()) {
+            log_throttle::rule rule;
+            rule.sample = item.value("sample", rule.sample);
+            auto rate_limit = item.find("rate_limit");
+            if (rate_limit != item.end() && rate_limit->is_object()) {
+                rule.rate = rate_limit->value("rate", rule.rate);
+                rule.burst = rate_limit->value("burst", rule.burst);
+            }
+            set_throttle(string_to_severity(sev), rule);
+        }
+    }
+
+    auto report_interval = opened_stream->find("throttle_report_interval_ms");
+    if (report_interval != opened_stream->end() && report_interval->is_number_unsigned()) {
+        _throttle_report_interval = std::chrono::milliseconds(report_interval->get<size_t>());
+    }
 
     auto format = opened_stream->find("format");
     if (format != opened_stream->end() && format->is_string()) {
@@ -55,12 +118,23 @@ logger_builder &client_logger_builder::transform_with_configuration(std::string
 
 logger_builder &client_logger_builder::clear() & {
     _output_streams.clear();
+    _binary_streams.clear();
     _format = "%m";
+    _throttle_rules.clear();
+    _throttle_report_interval = std::chrono::seconds(10);
     return *this;
 }
 
 logger *client_logger_builder::build() const {
-    return new client_logger(_output_streams, _format);
+    std::shared_ptr<log_throttle> throttle;
+    if (!_throttle_rules.empty()) {
+        throttle = std::make_shared<log_throttle>(_throttle_report_interval);
+        for (auto &[severity, rule]: _throttle_rules) {
+            throttle->set_rule(severity, rule);
+        }
+    }
+
+    return new client_logger(_output_streams, _binary_streams, _format, std::move(throttle));
 }
 
 logger_builder &client_logger_builder::set_format(const std::string &format) & {
@@ -68,23 +142,46 @@ logger_builder &client_logger_builder::set_format(const std::string &format) & {
     return *this;
 }
 
-void client_logger_builder::parse_severity(logger::severity sev, nlohmann::json &j) {
+void client_logger_builder::parse_severity(logger::severity sev, nlohmann::json &j,
+                                           client_logger::rotation_policy const &rotation) {
     if (j.empty() || !j.is_object()) return;
 
     auto opened_stream = _output_streams.find(sev);
 
+    // path is either a string or {"path": ..., "max_bytes": ..., "daily": ..., "max_files": ..., "mapped": bool}
     auto data_paths = j.find("paths");
     if (data_paths != j.end() && data_paths->is_array()) {
         json data = *data_paths;
         for (const json &js: data) {
-            if (js.empty() || !js.is_string()) continue;
+            if (js.empty()) continue;
+
+            std::string path;
+            client_logger::rotation_policy policy = rotation;
+            bool mapped = false;
+            if (js.is_string()) {
+                path = js;
+            } else if (js.is_object() && js.contains("path") && js["path"].is_string()) {
+                path = js["path"];
+                policy = parse_rotation(js, rotation);
+                mapped = js.value("mapped", false);
+            } else {
+                continue;
+            }
 
-            const std::string &path = js;
             if (opened_stream == _output_streams.end()) {
                 opened_stream = _output_streams.emplace(
                         sev, std::make_pair(std::forward_list<client_logger::refcounted_stream>(), false)).first;
             }
-            opened_stream->second.first.emplace_front(std::filesystem::weakly_canonical(path).string());
+            opened_stream->second.first.emplace_front(canonical_path(path), policy, mapped);
+        }
+    }
+
+    auto binary_paths = j.find("binary_paths");
+    if (binary_paths != j.end() && binary_paths->is_array()) {
+        for (const json &js: *binary_paths) {
+            if (js.empty() || !js.is_string()) continue;
+
+            add_binary_file_stream(js.get<std::string>(), sev);
         }
     }
 
@@ -101,3 +198,13 @@ void client_logger_builder::parse_severity(logger::severity sev, nlohmann::json
 logger_builder &client_logger_builder::set_destination(const std::string &format) & {
     return *this;
 }
+
+client_logger_builder &client_logger_builder::set_throttle(logger::severity severity, log_throttle::rule const &rule) & {
+    _throttle_rules[severity] = rule;
+    return *this;
+}
+
+client_logger_builder &client_logger_builder::set_throttle_report_interval(std::chrono::milliseconds interval) & {
+    _throttle_report_interval = interval;
+    return *this;
+}
@@ -0,0 +1,136 @@
+#include "../include/mapped_file.h"
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+
+mapped_file::mapped_file() noexcept = default;
+
+bool mapped_file::open(const std::string &path, bool truncate) {
+    _stream.open(path, std::ios_base::binary | (truncate ? std::ios_base::trunc : std::ios_base::app));
+    return _stream.is_open();
+}
+
+bool mapped_file::is_open() const noexcept {
+    return _stream.is_open();
+}
+
+void mapped_file::write(std::string_view data) {
+    if (!_stream.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+        throw std::ios_base::failure("Can't write to file");
+    }
+}
+
+void mapped_file::close() noexcept {
+    _stream.close();
+}
+
+void mapped_file::swap(mapped_file &other) noexcept {
+    _stream.swap(other._stream);
+}
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+mapped_file::mapped_file() noexcept: _fd(-1), _data(nullptr), _capacity(0), _size(0) {
+}
+
+bool mapped_file::open(const std::string &path, bool truncate) {
+    close();
+
+    _fd = ::open(path.c_str(), O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+    if (_fd == -1) {
+        return false;
+    }
+
+    // close() would truncate file to _size, which is only known after fstat
+    struct stat info{};
+    if (::fstat(_fd, &info) == -1) {
+        ::close(_fd);
+        _fd = -1;
+        return false;
+    }
+
+    _size = static_cast<size_t>(info.st_size);
+    if (!reserve(_size + 1)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool mapped_file::reserve(size_t required) {
+    if (required <= _capacity) {
+        return true;
+    }
+
+    size_t capacity = (required + chunk_size - 1) / chunk_size * chunk_size;
+
+    // old mapping is kept until new one exists, so failed grow leaves file writable
+    if (::ftruncate(_fd, static_cast<off_t>(capacity)) == -1) {
+        return false;
+    }
+
+    void *data = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    if (_data != nullptr) {
+        ::munmap(_data, _capacity);
+    }
+    _data = static_cast<char *>(data);
+    _capacity = capacity;
+    return true;
+}
+
+bool mapped_file::is_open() const noexcept {
+    return _data != nullptr;
+}
+
+void mapped_file::write(std::string_view data) {
+    if (_data == nullptr) {
+        throw std::ios_base::failure("Mapped file is not open");
+    }
+
+    if (!reserve(_size + data.size())) {
+        throw std::ios_base::failure("Can't grow mapped file to " + std::to_string(_size + data.size()) + " bytes");
+    }
+
+    std::memcpy(_data + _size, data.data(), data.size());
+    _size += data.size();
+}
+
+void mapped_file::close() noexcept {
+    if (_data != nullptr) {
+        ::munmap(_data, _capacity);
+        _data = nullptr;
+    }
+
+    if (_fd != -1) {
+        // drops preallocated tail
+        [[maybe_unused]] int res = ::ftruncate(_fd, static_cast<off_t>(_size));
+        ::close(_fd);
+        _fd = -1;
+    }
+
+    _capacity = 0;
+    _size = 0;
+}
+
+void mapped_file::swap(mapped_file &other) noexcept {
+    std::swap(_fd, other._fd);
+    std::swap(_data, other._data);
+    std::swap(_capacity, other._capacity);
+    std::swap(_size, other._size);
+}
+
+#endif
+
+mapped_file::~mapped_file() {
+    close();
+}
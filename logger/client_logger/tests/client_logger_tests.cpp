@@ -1,8 +1,330 @@
 #include <gtest/gtest.h>
 #include "../include/client_logger.h"
 #include "../include/client_logger_builder.h"
+#include "../include/binary_log_record.h"
 
 #include <filesystem>
+#include <thread>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+TEST(binary_stream, records_are_read_back)
+{
+    std::filesystem::remove("binary_log.bin");
+
+    {
+        client_logger_builder builder;
+        builder.add_binary_file_stream("binary_log.bin", logger::severity::trace).
+                add_binary_file_stream("binary_log.bin", logger::severity::error);
+
+        std::unique_ptr<logger> log(builder.build());
+        log->trace("first").debug("skipped").error("second");
+    }
+
+    std::ifstream stream("binary_log.bin", std::ios_base::binary);
+    ASSERT_TRUE(binary_log::read_file_header(stream));
+
+    binary_log::record record;
+    ASSERT_TRUE(binary_log::read_record(stream, record));
+    EXPECT_EQ(record.severity, logger::severity::trace);
+    EXPECT_EQ(record.payload, "first");
+
+    ASSERT_TRUE(binary_log::read_record(stream, record));
+    EXPECT_EQ(record.severity, logger::severity::error);
+    EXPECT_EQ(record.payload, "second");
+
+    EXPECT_FALSE(binary_log::read_record(stream, record));
+}
+
+TEST(rotation, shared_file_is_rotated_by_size)
+{
+    for (auto &path: {"rotated.txt", "rotated.txt.1", "rotated.txt.2", "rotated.txt.3"})
+    {
+        std::filesystem::remove(path);
+    }
+
+    client_logger::rotation_policy policy;
+    policy.max_bytes = 16;
+    policy.max_files = 2;
+
+    client_logger_builder builder;
+    builder.add_file_stream("rotated.txt", logger::severity::information, policy);
+
+    std::unique_ptr<logger> first(builder.build());
+    std::unique_ptr<logger> second(builder.build());
+
+    first->information("line 1");
+    second->information("line 2");
+    first->information("line 3");
+    second->information("line 4");
+    first->information("line 5");
+
+    EXPECT_TRUE(std::filesystem::exists("rotated.txt.1"));
+    EXPECT_TRUE(std::filesystem::exists("rotated.txt.2"));
+    EXPECT_FALSE(std::filesystem::exists("rotated.txt.3"));
+
+    first.reset();
+    second.reset();
+    builder.clear();
+
+    std::ifstream current("rotated.txt");
+    std::string line;
+    std::getline(current, line);
+    EXPECT_EQ(line, "line 5");
+}
+
+TEST(rotation, concurrent_rotations_keep_order)
+{
+    constexpr size_t threads_count = 4, lines_count = 200, max_files = 64;
+    for (size_t i = 0; i <= max_files + 1; ++i)
+    {
+        std::filesystem::remove(i == 0 ? std::string("rotated_mt.txt") : "rotated_mt.txt." + std::to_string(i));
+    }
+
+    client_logger::rotation_policy policy;
+    policy.max_bytes = 1000;
+    policy.max_files = max_files;
+
+    {
+        client_logger_builder builder;
+        builder.add_file_stream("rotated_mt.txt", logger::severity::information, policy);
+        std::unique_ptr<logger> prototype(builder.build());
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < threads_count; ++i)
+        {
+            threads.emplace_back([&, i]()
+            {
+                client_logger log(dynamic_cast<client_logger const &>(*prototype));
+                for (size_t j = 0; j < lines_count; ++j)
+                {
+                    log.information(std::to_string(i) + " " + std::to_string(j));
+                }
+            });
+        }
+
+        for (auto &thread: threads)
+        {
+            thread.join();
+        }
+    }
+
+    // oldest backup first, every thread's lines must come in the order they were logged
+    std::vector<size_t> next(threads_count, 0);
+    for (size_t i = max_files + 1; i-- > 0;)
+    {
+        std::string path = i == 0 ? std::string("rotated_mt.txt") : "rotated_mt.txt." + std::to_string(i);
+        std::ifstream stream(path);
+        size_t thread, index;
+        while (stream >> thread >> index)
+        {
+            ASSERT_LT(thread, threads_count);
+            ASSERT_EQ(index, next[thread]);
+            ++next[thread];
+        }
+        std::filesystem::remove(path);
+    }
+
+    for (size_t count: next)
+    {
+        EXPECT_EQ(count, lines_count);
+    }
+    for (auto &entry: std::filesystem::directory_iterator("."))
+    {
+        EXPECT_EQ(entry.path().filename().string().find("rotated_mt.txt.rotating"), std::string::npos);
+    }
+}
+
+TEST(mapped_file, file_is_truncated_on_close)
+{
+    std::filesystem::remove("mapped.txt");
+
+    client_logger_builder builder;
+    builder.add_mapped_file_stream("mapped.txt", logger::severity::information);
+
+    std::unique_ptr<logger> log(builder.build());
+    for (int i = 0; i < 100; ++i)
+    {
+        log->information("line " + std::to_string(i));
+    }
+
+    EXPECT_GE(std::filesystem::file_size("mapped.txt"), mapped_file::chunk_size);
+
+    log.reset();
+    builder.clear();
+
+    std::ifstream file("mapped.txt");
+    std::string line;
+    int count = 0;
+    while (std::getline(file, line))
+    {
+        EXPECT_EQ(line, "line " + std::to_string(count));
+        ++count;
+    }
+    EXPECT_EQ(count, 100);
+}
+
+TEST(string_view, slices_are_logged_as_is)
+{
+    std::filesystem::remove("string_view.txt");
+
+    client_logger_builder builder;
+    builder.add_file_stream("string_view.txt", logger::severity::information);
+    builder.set_format("[%s] %m");
+
+    std::unique_ptr<logger> log(builder.build());
+
+    std::string_view text = "first second third";
+    log->information(text.substr(6, 6));
+    log->log(text.substr(0, 5), logger::severity::information);
+
+    log.reset();
+    builder.clear();
+
+    std::ifstream file("string_view.txt");
+    std::string line;
+    std::getline(file, line);
+    EXPECT_EQ(line, "[INFORMATION] second");
+    std::getline(file, line);
+    EXPECT_EQ(line, "[INFORMATION] first");
+}
+
+TEST(concurrency, lines_are_not_interleaved)
+{
+    std::filesystem::remove("concurrent.txt");
+
+    constexpr size_t threads_count = 8, lines_count = 500;
+    const std::string line(100, 'x');
+
+    {
+        client_logger_builder builder;
+        builder.add_file_stream("concurrent.txt", logger::severity::information);
+        std::unique_ptr<logger> prototype(builder.build());
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < threads_count; ++i)
+        {
+            threads.emplace_back([&]()
+            {
+                client_logger log(dynamic_cast<client_logger const &>(*prototype));
+                for (size_t j = 0; j < lines_count; ++j)
+                {
+                    log.information(line);
+                }
+            });
+        }
+
+        for (auto &thread: threads)
+        {
+            thread.join();
+        }
+    }
+
+    std::ifstream stream("concurrent.txt");
+    size_t count = 0;
+    for (std::string read; std::getline(stream, read); ++count)
+    {
+        ASSERT_EQ(read, line);
+    }
+    EXPECT_EQ(count, threads_count * lines_count);
+}
+
+TEST(throttle, sampled_messages_are_reported)
+{
+    std::filesystem::remove("sampled.txt");
+
+    {
+        log_throttle::rule rule;
+        rule.sample = 3;
+
+        client_logger_builder builder;
+        builder.add_file_stream("sampled.txt", logger::severity::debug);
+        builder.set_throttle(logger::severity::debug, rule).set_throttle_report_interval(std::chrono::hours(1));
+
+        std::unique_ptr<logger> log(builder.build());
+        for (size_t i = 0; i < 9; ++i)
+        {
+            log->debug(std::to_string(i));
+        }
+    }
+
+    std::ifstream stream("sampled.txt");
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(stream, line);)
+    {
+        lines.push_back(line);
+    }
+
+    EXPECT_EQ(lines, (std::vector<std::string>{"0", "3", "6", log_throttle::report_message(6)}));
+}
+
+TEST(throttle, rules_are_read_from_configuration)
+{
+    std::filesystem::remove("sampled_config.txt");
+
+    {
+        std::ofstream config("throttle_config.json");
+        config << R"({"log": {"debug": {"paths": ["sampled_config.txt"]},
+                              "throttle": {"DEBUG": {"sample": 4}},
+                              "throttle_report_interval_ms": 3600000}})";
+    }
+
+    {
+        client_logger_builder builder;
+        builder.transform_with_configuration("throttle_config.json", "log");
+
+        std::unique_ptr<logger> log(builder.build());
+        for (size_t i = 0; i < 8; ++i)
+        {
+            log->debug(std::to_string(i));
+        }
+    }
+    std::filesystem::remove("throttle_config.json");
+
+    std::ifstream stream("sampled_config.txt");
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(stream, line);)
+    {
+        lines.push_back(line);
+    }
+
+    EXPECT_EQ(lines, (std::vector<std::string>{"0", "4", log_throttle::report_message(6)}));
+}
+
+#ifndef _WIN32
+TEST(mapped_file, failed_grow_is_reported_and_file_stays_open)
+{
+    std::filesystem::remove("mapped_limit.txt");
+
+    mapped_file file;
+    ASSERT_TRUE(file.open("mapped_limit.txt", true));
+
+    // file size limit makes ftruncate past first chunk fail with EFBIG instead of raising SIGXFSZ
+    rlimit old_limit{};
+    ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &old_limit), 0);
+    auto old_handler = std::signal(SIGXFSZ, SIG_IGN);
+    rlimit limit = old_limit;
+    limit.rlim_cur = mapped_file::chunk_size;
+    ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &limit), 0);
+
+    file.write("first\n");
+    EXPECT_THROW(file.write(std::string(mapped_file::chunk_size, 'x')), std::ios_base::failure);
+
+    setrlimit(RLIMIT_FSIZE, &old_limit);
+    std::signal(SIGXFSZ, old_handler);
+
+    EXPECT_TRUE(file.is_open());
+    file.write("second\n");
+    file.close();
+
+    std::ifstream stream("mapped_limit.txt");
+    std::string content((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, "first\nsecond\n");
+}
+#endif
 
 int main(int argc, char *argv[])
 {
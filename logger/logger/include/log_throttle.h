@@ -0,0 +1,78 @@
+#ifndef MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_THROTTLE_H
+#define MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_THROTTLE_H
+
+#include "logger.h"
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** Per-severity sampling (1 of every sample messages passes) and token bucket
+ *  (rate messages per second, up to burst at once). Number of dropped messages
+ *  is reported at most once per report_interval, with next admitted message of that severity
+ */
+class log_throttle final
+{
+
+public:
+
+    struct rule
+    {
+        size_t sample = 1;
+        double rate = 0;// 0 - no rate limit
+        double burst = 0;// 0 - same as rate
+
+        bool enabled() const noexcept { return sample > 1 || rate > 0; }
+    };
+
+private:
+
+    struct state
+    {
+        rule settings;
+        std::mutex mut;
+        size_t seen = 0;
+        double tokens = 0;
+        std::chrono::steady_clock::time_point last_refill;
+        size_t suppressed = 0;
+        std::chrono::steady_clock::time_point last_report;
+    };
+
+    static constexpr size_t severities_count = static_cast<size_t>(logger::severity::critical) + 1;
+
+    std::array<state, severities_count> _states;
+
+    std::chrono::milliseconds _report_interval;
+
+public:
+
+    explicit log_throttle(
+        std::chrono::milliseconds report_interval = std::chrono::seconds(10));
+
+    log_throttle(log_throttle const &other) = delete;
+
+    log_throttle &operator=(log_throttle const &other) = delete;
+
+public:
+
+    void set_rule(
+        logger::severity severity,
+        rule const &settings);
+
+    /** Returns false if message should be dropped. If suppressed_to_report isn't 0 after call,
+     *  caller should emit report_message for it
+     */
+    bool admit(
+        logger::severity severity,
+        size_t &suppressed_to_report);
+
+    //takes counts that weren't reported yet regardless of interval
+    std::vector<std::pair<logger::severity, size_t>> take_suppressed();
+
+    static std::string report_message(
+        size_t suppressed);
+
+};
+
+#endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOG_THROTTLE_H
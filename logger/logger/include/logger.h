@@ -2,6 +2,15 @@
 #define MATH_PRACTICE_AND_OPERATING_SYSTEMS_LOGGER_H
 
 #include <iostream>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <version>
+#ifdef __cpp_lib_format
+#include <format>
+#include <iterator>
+#endif
 
 class logger
 {
@@ -25,28 +34,105 @@ public:
 public:
 
     virtual logger& log(
-        std::string const &message,
+        std::string_view message,
         logger::severity severity) & = 0;
 
+#ifdef __cpp_lib_format
+
+    /** Arguments are formatted into thread local buffer which is reused between calls,
+     *  so formatting doesn't allocate once buffer has grown to line size
+     */
+    template<typename... Args>
+    logger& log(
+        logger::severity severity,
+        std::format_string<Args...> format,
+        Args &&...args) &
+    {
+        std::string &buffer = format_buffer();
+        buffer.clear();
+        std::format_to(std::back_inserter(buffer), format, std::forward<Args>(args)...);
+        return log(std::string_view(buffer), severity);
+    }
+
+#endif
+
 public:
 
     logger& trace(
-        std::string const &message) &;
+        std::string_view message) &;
 
     logger& debug(
-        std::string const &message) &;
+        std::string_view message) &;
 
     logger& information(
-        std::string const &message) &;
+        std::string_view message) &;
 
     logger& warning(
-        std::string const &message) &;
+        std::string_view message) &;
 
     logger& error(
-        std::string const &message) &;
+        std::string_view message) &;
 
     logger& critical(
-        std::string const &message) &;
+        std::string_view message) &;
+
+#ifdef __cpp_lib_format
+
+    template<typename Arg, typename... Args>
+    logger& trace(
+        std::format_string<Arg, Args...> format,
+        Arg &&arg,
+        Args &&...args) &
+    {
+        return log(logger::severity::trace, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<typename Arg, typename... Args>
+    logger& debug(
+        std::format_string<Arg, Args...> format,
+        Arg &&arg,
+        Args &&...args) &
+    {
+        return log(logger::severity::debug, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<typename Arg, typename... Args>
+    logger& information(
+        std::format_string<Arg, Args...> format,
+        Arg &&arg,
+        Args &&...args) &
+    {
+        return log(logger::severity::information, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<typename Arg, typename... Args>
+    logger& warning(
+        std::format_string<Arg, Args...> format,
+        Arg &&arg,
+        Args &&...args) &
+    {
+        return log(logger::severity::warning, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<typename Arg, typename... Args>
+    logger& error(
+        std::format_string<Arg, Args...> format,
+        Arg &&arg,
+        Args &&...args) &
+    {
+        return log(logger::severity::error, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<typename Arg, typename... Args>
+    logger& critical(
+        std::format_string<Arg, Args...> format,
+        Arg &&arg,
+        Args &&...args) &
+    {
+        return log(logger::severity::critical, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+#endif
 
 protected:
 
@@ -59,6 +145,18 @@ protected:
 
     static std::string current_time_to_string();
 
+    static std::string date_to_string(std::time_t time);
+
+    static std::string time_to_string(std::time_t time);
+
+    //append to out without temporary strings
+    static void append_date(std::string &out, std::time_t time);
+
+    static void append_time(std::string &out, std::time_t time);
+
+    //thread local, reused by formatting overloads
+    static std::string &format_buffer();
+
 };
 
 
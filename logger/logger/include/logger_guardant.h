@@ -13,26 +13,99 @@ public:
 public:
 
     logger_guardant & log_with_guard(
-        std::string const &message,
+        std::string_view message,
         logger::severity severity) &;
 
     logger_guardant &trace_with_guard(
-        std::string const &message) &;
+        std::string_view message) &;
 
     logger_guardant &debug_with_guard(
-        std::string const &message) &;
+        std::string_view message) &;
 
     logger_guardant &information_with_guard(
-        std::string const &message) &;
+        std::string_view message) &;
 
     logger_guardant &warning_with_guard(
-        std::string const &message) &;
+        std::string_view message) &;
 
     logger_guardant &error_with_guard(
-        std::string const &message) &;
+        std::string_view message) &;
 
     logger_guardant &critical_with_guard(
-        std::string const &message) &;
+        std::string_view message) &;
+
+#ifdef __cpp_lib_format
+
+    template<typename... Args>
+    logger_guardant &log_with_guard(
+        logger::severity severity,
+        std::format_string<Args...> format,
+        Args &&...args) &
+    {
+        logger *got_logger = get_logger();
+        if (got_logger != nullptr)
+        {
+            got_logger->log(severity, format, std::forward<Args>(args)...);
+        }
+
+        return *this;
+    }
+
+    template<typename Arg, typename... Args>
+    logger_guardant &trace_with_guard(
+        std::format_string<Arg, Args...> format,
+        Arg &&arg,
+        Args &&...args) &
+    {
+        return log_with_guard(logger::severity::trace, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<typename Arg, typename... Args>
+    logger_guardant &debug_with_guard(
+        std::format_string<Arg, Args...> format,
+        Arg &&arg,
+        Args &&...args) &
+    {
+        return log_with_guard(logger::severity::debug, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<typename Arg, typename... Args>
+    logger_guardant &information_with_guard(
+        std::format_string<Arg, Args...> format,
+        Arg &&arg,
+        Args &&...args) &
+    {
+        return log_with_guard(logger::severity::information, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<typename Arg, typename... Args>
+    logger_guardant &warning_with_guard(
+        std::format_string<Arg, Args...> format,
+        Arg &&arg,
+        Args &&...args) &
+    {
+        return log_with_guard(logger::severity::warning, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<typename Arg, typename... Args>
+    logger_guardant &error_with_guard(
+        std::format_string<Arg, Args...> format,
+        Arg &&arg,
+        Args &&...args) &
+    {
+        return log_with_guard(logger::severity::error, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+    template<typename Arg, typename... Args>
+    logger_guardant &critical_with_guard(
+        std::format_string<Arg, Args...> format,
+        Arg &&arg,
+        Args &&...args) &
+    {
+        return log_with_guard(logger::severity::critical, format, std::forward<Arg>(arg), std::forward<Args>(args)...);
+    }
+
+#endif
 
 protected:
 
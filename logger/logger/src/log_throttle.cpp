@@ -0,0 +1,102 @@
+#include "../include/log_throttle.h"
+#include <algorithm>
+
+log_throttle::log_throttle(
+    std::chrono::milliseconds report_interval):
+        _report_interval(report_interval)
+{
+    auto now = std::chrono::steady_clock::now();
+    for (auto &st: _states)
+    {
+        st.last_refill = now;
+        st.last_report = now;
+    }
+}
+
+void log_throttle::set_rule(
+    logger::severity severity,
+    log_throttle::rule const &settings)
+{
+    state &st = _states[static_cast<size_t>(severity)];
+
+    std::lock_guard lock(st.mut);
+    st.settings = settings;
+    if (st.settings.sample == 0)
+    {
+        st.settings.sample = 1;
+    }
+    if (st.settings.burst < 1)
+    {
+        st.settings.burst = std::max(st.settings.rate, 1.0);
+    }
+    st.tokens = st.settings.burst;
+    st.last_refill = std::chrono::steady_clock::now();
+}
+
+bool log_throttle::admit(
+    logger::severity severity,
+    size_t &suppressed_to_report)
+{
+    state &st = _states[static_cast<size_t>(severity)];
+    suppressed_to_report = 0;
+
+    std::lock_guard lock(st.mut);
+    if (!st.settings.enabled())
+    {
+        return true;
+    }
+
+    bool admitted = st.seen++ % st.settings.sample == 0;
+
+    auto now = std::chrono::steady_clock::now();
+    if (admitted && st.settings.rate > 0)
+    {
+        std::chrono::duration<double> elapsed = now - st.last_refill;
+        st.tokens = std::min(st.settings.burst, st.tokens + elapsed.count() * st.settings.rate);
+        st.last_refill = now;
+
+        admitted = st.tokens >= 1;
+        if (admitted)
+        {
+            st.tokens -= 1;
+        }
+    }
+
+    if (!admitted)
+    {
+        ++st.suppressed;
+        return false;
+    }
+
+    if (st.suppressed != 0 && now - st.last_report >= _report_interval)
+    {
+        suppressed_to_report = st.suppressed;
+        st.suppressed = 0;
+        st.last_report = now;
+    }
+
+    return true;
+}
+
+std::vector<std::pair<logger::severity, size_t>> log_throttle::take_suppressed()
+{
+    std::vector<std::pair<logger::severity, size_t>> result;
+
+    for (size_t i = 0; i < severities_count; ++i)
+    {
+        std::lock_guard lock(_states[i].mut);
+        if (_states[i].suppressed != 0)
+        {
+            result.emplace_back(static_cast<logger::severity>(i), _states[i].suppressed);
+            _states[i].suppressed = 0;
+        }
+    }
+
+    return result;
+}
+
+std::string log_throttle::report_message(
+    size_t suppressed)
+{
+    return "[throttle] " + std::to_string(suppressed) + " messages suppressed";
+}
@@ -3,37 +3,37 @@
 #include <sstream>
 
 logger & logger::trace(
-    std::string const &message) &
+    std::string_view message) &
 {
     return log(message, logger::severity::trace);
 }
 
 logger &logger::debug(
-    std::string const &message) &
+    std::string_view message) &
 {
     return log(message, logger::severity::debug);
 }
 
 logger &logger::information(
-    std::string const &message) &
+    std::string_view message) &
 {
     return log(message, logger::severity::information);
 }
 
 logger &logger::warning(
-    std::string const &message) &
+    std::string_view message) &
 {
     return log(message, logger::severity::warning);
 }
 
 logger & logger::error(
-    std::string const &message) &
+    std::string_view message) &
 {
     return log(message, logger::severity::error);
 }
 
 logger &logger::critical(
-    std::string const &message) &
+    std::string_view message) &
 {
     return log(message, logger::severity::critical);
 }
@@ -60,32 +60,79 @@ std::string logger::severity_to_string(
     throw std::out_of_range("Invalid severity value");
 }
 
+// std::localtime returns pointer to shared static object, loggers are used from many threads
+static std::tm to_local_time(
+    std::time_t time)
+{
+    std::tm result{};
+#ifdef _WIN32
+    localtime_s(&result, &time);
+#else
+    localtime_r(&time, &result);
+#endif
+    return result;
+}
+
 std::string logger::current_datetime_to_string()
 {
-    auto time = std::time(nullptr);
+    auto time = to_local_time(std::time(nullptr));
 
     std::ostringstream result_stream;
-    result_stream << std::put_time(std::localtime(&time), "%d.%m.%Y %H:%M:%S");
+    result_stream << std::put_time(&time, "%d.%m.%Y %H:%M:%S");
 
     return result_stream.str();
 }
 
 std::string logger::current_date_to_string()
 {
-    auto time = std::time(nullptr);
+    return date_to_string(std::time(nullptr));
+}
 
-    std::ostringstream result_stream;
-    result_stream << std::put_time(std::localtime(&time), "%d.%m.%Y");
+std::string logger::current_time_to_string()
+{
+    return time_to_string(std::time(nullptr));
+}
 
-    return result_stream.str();
+std::string logger::date_to_string(
+    std::time_t time)
+{
+    std::string result;
+    append_date(result, time);
+
+    return result;
 }
 
-std::string logger::current_time_to_string()
+std::string logger::time_to_string(
+    std::time_t time)
 {
-    auto time = std::time(nullptr);
+    std::string result;
+    append_time(result, time);
 
-    std::ostringstream result_stream;
-    result_stream << std::put_time(std::localtime(&time), "%H:%M:%S");
+    return result;
+}
 
-    return result_stream.str();
+void logger::append_date(
+    std::string &out,
+    std::time_t time)
+{
+    auto local_time = to_local_time(time);
+
+    char buffer[32];
+    out.append(buffer, std::strftime(buffer, sizeof(buffer), "%d.%m.%Y", &local_time));
+}
+
+void logger::append_time(
+    std::string &out,
+    std::time_t time)
+{
+    auto local_time = to_local_time(time);
+
+    char buffer[32];
+    out.append(buffer, std::strftime(buffer, sizeof(buffer), "%H:%M:%S", &local_time));
+}
+
+std::string &logger::format_buffer()
+{
+    thread_local std::string buffer;
+    return buffer;
 }
@@ -2,22 +2,151 @@
 #define MATH_PRACTICE_AND_OPERATING_SYSTEMS_SERVER_LOGGER_H
 
 #include <logger.h>
+#include <log_throttle.h>
 #include <unordered_map>
 #include <httplib.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 class server_logger_builder;class server_logger final : public logger
 {
-    httplib::Client _client;
+public:
+    struct spool_metrics
+    {
+        size_t depth_messages = 0;
+        size_t depth_bytes = 0;
+        size_t replayed_messages = 0;
+        size_t dropped_messages = 0;
+        double replay_rate = 0;// messages per second during the last replay
+    };
+
+private:
+    //region batch_sender
+
+    /** Accumulates formatted messages and sends them to /log_batch as one POST body
+     *  (JSON lines: {"sev": ..., "message": ...}) from a background thread,
+     *  when max_batch_size messages are pending or flush_interval has passed.
+     *  Batches that can't be delivered are appended to spool file (up to spool_max_bytes)
+     *  and replayed in order once server is reachable again, spool left by previous process is replayed too.
+     *  Spool file is locked while sender lives, so loggers running at the same time never share one.
+     *  While server is unreachable replay is retried with exponential backoff.
+     *  Streams are registered again after a failed post or when server doesn't know pid (it has restarted),
+     *  batches server rejects otherwise are dropped
+     */
+    class batch_sender final
+    {
+        enum class delivery { delivered, rejected, failed };
+
+        httplib::Client _client;
+        std::mutex _client_mut;
+
+        std::string _pid;
+        std::vector<std::string> _init_urls;
+        bool _registered;
+        size_t _max_batch_size;
+        std::chrono::milliseconds _flush_interval;
+
+        // spool is touched by worker thread only, counters are read by metrics()
+        std::string _spool_path;
+        size_t _spool_max_bytes;
+#ifdef _WIN32
+        void *_spool_lock;
+#else
+        int _spool_lock;
+#endif
+        std::chrono::milliseconds _retry_delay;
+        std::chrono::steady_clock::time_point _next_retry;
+        std::atomic<size_t> _spooled_messages;
+        std::atomic<size_t> _spooled_bytes;
+        std::atomic<size_t> _replayed_messages;
+        std::atomic<size_t> _dropped_messages;
+        std::atomic<double> _replay_rate;
+
+        std::mutex _mut;
+        std::condition_variable _cv;
+        std::string _pending;
+        size_t _pending_count;
+        bool _stopped;
+
+        std::thread _worker;
+
+        void run();
+
+        //called with _client_mut held
+        bool register_streams();
+
+        delivery post(std::string const& body);
+
+        void send(std::string const& body, size_t count);
+
+        /** Takes path, or the first of "<path>.1", "<path>.2", ... that no other logger holds,
+         *  leaves spool path empty if every slot is taken
+         */
+        void acquire_spool(const std::string& path);
+
+        bool try_lock_spool(const std::string& lock_path);
+
+        void release_spool() noexcept;
+
+        // called after every post, delay between replay attempts doubles while they fail
+        void update_backoff(bool delivered);
+
+        void spool(std::string const& body, size_t count);
+
+        //returns true if spool is empty after replay
+        bool replay_spool();
+
+    public:
+        batch_sender(const std::string& dest, std::string pid, std::vector<std::string> init_urls,
+                     size_t max_batch_size, std::chrono::milliseconds flush_interval,
+                     std::string spool_path, size_t spool_max_bytes);
+
+        batch_sender(const batch_sender&) = delete;
+        batch_sender& operator=(const batch_sender&) = delete;
+        batch_sender(batch_sender&&) noexcept = delete;
+        batch_sender& operator=(batch_sender&&) noexcept = delete;
+
+        //sends request immediately, bypassing the batch
+        void get(const std::string& url);
+
+        //message is escaped straight into pending body
+        void push(std::string_view severity, std::string_view message);
+
+        //sends everything that is pending and joins worker
+        void stop();
+
+        spool_metrics metrics() const noexcept;
+
+        ~batch_sender();
+    };
+
+    //endregion batch_sender
+
+    std::unique_ptr<batch_sender> _sender;
     std::unordered_map<logger::severity, std::pair<std::string, bool>> _streams;
     std::string _format;
 
+    //nullptr if nothing is throttled
+    std::unique_ptr<log_throttle> _throttle;
+
 public:
     enum class flag { DATE, TIME, SEVERITY, MESSAGE, NO_FLAG };
 
 protected:
     server_logger(const std::string& dest,
                   const std::unordered_map<logger::severity, std::pair<std::string, bool>>& streams,
-                  std::string  format);
+                  std::string  format,
+                  size_t max_batch_size,
+                  std::chrono::milliseconds flush_interval,
+                  const std::string& spool_path,
+                  size_t spool_max_bytes,
+                  std::unique_ptr<log_throttle> throttle);
 
     friend server_logger_builder;
 
@@ -25,7 +154,9 @@ public:
     static int inner_getpid();
 
 
-    std::string make_format(const std::string& message, severity sev) const;
+    std::string make_format(std::string_view message, severity sev) const;
+
+    void append_format(std::string& out, std::string_view message, severity sev) const;
     static flag char_to_flag(char c) noexcept;
 
     server_logger(server_logger const& other) = delete;
@@ -34,7 +165,11 @@ public:
     server_logger& operator=(server_logger&& other) noexcept;
     ~server_logger() noexcept override;
 
-    [[nodiscard]] logger& log(const std::string& message, logger::severity severity) & override;
+    spool_metrics metrics() const noexcept;
+
+    using logger::log;
+
+    [[nodiscard]] logger& log(std::string_view message, logger::severity severity) & override;
 };
 
 #endif //MATH_PRACTICE_AND_OPERATING_SYSTEMS_SERVER_LOGGER_H
\ No newline at end of file
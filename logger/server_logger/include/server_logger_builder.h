@@ -3,6 +3,7 @@
 
 #include <logger_builder.h>
 #include <unordered_map>
+#include <chrono>
 #include "server_logger.h"
 #include <nlohmann/json.hpp>
 
@@ -12,15 +13,26 @@ class server_logger_builder final : public logger_builder
     std::string _destination;
     std::string _format;
     std::unordered_map<logger::severity, std::pair<std::string, bool>> _output_streams;
+    size_t _max_batch_size;
+    std::chrono::milliseconds _flush_interval;
+    std::string _spool_path;
+    size_t _spool_max_bytes;
+    std::unordered_map<logger::severity, log_throttle::rule> _throttle_rules;
+    std::chrono::milliseconds _throttle_report_interval;
 
 public:
-    server_logger_builder() : _destination("http://127.0.0.1:9200"), _format("[%s] %m") {}
+    server_logger_builder() : _destination("http://127.0.0.1:9200"), _format("[%s] %m"),
+                              _max_batch_size(64), _flush_interval(100),
+                              _spool_path("server_logger.spool"), _spool_max_bytes(16 * 1024 * 1024),
+                              _throttle_report_interval(std::chrono::seconds(10)) {}
 
     logger_builder& add_file_stream(std::string const& stream_file_path,
                                     logger::severity severity) & override;
 
     logger_builder& add_console_stream(logger::severity severity) & override;
 
+    /** Throttle rules are read from "throttle" object keyed by severity name, the same way client_logger_builder does
+     */
     logger_builder& transform_with_configuration(std::string const& configuration_file_path,
                                                  std::string const& configuration_path) & override;
 
@@ -28,6 +40,21 @@ public:
     logger_builder& clear() & override;
     logger_builder& set_format(const std::string& format) & override;
 
+    /** Messages are sent when max_batch_size of them are pending or flush_interval has passed
+     */
+    server_logger_builder& set_batching(size_t max_batch_size, std::chrono::milliseconds flush_interval) &;
+
+    /** Undelivered messages are kept in file at path until server is back, if process exits before that,
+     *  next logger with the same path replays them. Path is locked while logger lives, loggers running
+     *  at the same time with the same path take "<path>.1", "<path>.2", ... instead.
+     *  Empty path disables spooling
+     */
+    server_logger_builder& set_spool(const std::string& path, size_t max_bytes) &;
+
+    server_logger_builder& set_throttle(logger::severity severity, log_throttle::rule const& rule) &;
+
+    server_logger_builder& set_throttle_report_interval(std::chrono::milliseconds interval) &;
+
     [[nodiscard]] logger* build() const override;
 };
 
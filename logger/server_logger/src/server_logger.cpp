@@ -1,56 +1,478 @@
 #include "../include/server_logger.h"
 #include <httplib.h>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
 
 #ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
 #include <process.h>
+#include <windows.h>
 #include <fstream>
 #include <sstream>
 #include <utility>
 #else
 
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif
 
+namespace {
+    // another logger holding "<path>" moves this one to "<path>.1" and so on
+    constexpr size_t spool_slots = 64;
+
+    constexpr std::chrono::milliseconds min_retry_delay(50);
+    constexpr std::chrono::milliseconds max_retry_delay(30000);
+}
+
+server_logger::batch_sender::batch_sender(const std::string &dest, std::string pid, std::vector<std::string> init_urls,
+                                          size_t max_batch_size, std::chrono::milliseconds flush_interval,
+                                          std::string spool_path, size_t spool_max_bytes)
+        : _client(dest), _pid(std::move(pid)), _init_urls(std::move(init_urls)), _registered(false),
+          _max_batch_size(max_batch_size == 0 ? 1 : max_batch_size),
+          _flush_interval(flush_interval), _spool_max_bytes(spool_max_bytes),
+#ifdef _WIN32
+          _spool_lock(nullptr),
+#else
+          _spool_lock(-1),
+#endif
+          _retry_delay(min_retry_delay),
+          _spooled_messages(0), _spooled_bytes(0), _replayed_messages(0), _dropped_messages(0), _replay_rate(0),
+          _pending_count(0), _stopped(false) {
+    _client.set_keep_alive(true);
+    _client.set_connection_timeout(1);
+    _client.set_read_timeout(5);
+    _client.set_write_timeout(5);
+
+    {
+        std::lock_guard lock(_client_mut);
+        _registered = register_streams();
+    }
+
+    // spool left by previous process is replayed by worker as if this one had written it
+    if (!spool_path.empty()) {
+        acquire_spool(spool_path);
+    }
+    if (!_spool_path.empty()) {
+        std::ifstream file(_spool_path, std::ios_base::binary);
+        if (file.is_open()) {
+            std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            _spooled_bytes = content.size();
+            _spooled_messages = static_cast<size_t>(std::count(content.begin(), content.end(), '\n'));
+        }
+    }
+
+    _worker = std::thread(&batch_sender::run, this);
+}
+
+server_logger::batch_sender::~batch_sender() {
+    stop();
+    release_spool();
+}
+
+void server_logger::batch_sender::acquire_spool(const std::string &path) {
+    // first pass looks only at spools left by exited processes, so that they get replayed
+    for (int pass = 0; pass < 2; ++pass) {
+        for (size_t slot = 0; slot < spool_slots; ++slot) {
+            std::string candidate = slot == 0 ? path : path + "." + std::to_string(slot);
+            std::error_code error;
+            if (pass == 0 && !std::filesystem::exists(candidate, error)) {
+                continue;
+            }
+            if (try_lock_spool(candidate + ".lock")) {
+                _spool_path = std::move(candidate);
+                return;
+            }
+        }
+    }
+}
+
+#ifdef _WIN32
+
+bool server_logger::batch_sender::try_lock_spool(const std::string &lock_path) {
+    // exclusive open is the lock itself, file is removed when its handle is closed
+    HANDLE handle = CreateFileA(lock_path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS,
+                                FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    _spool_lock = handle;
+    return true;
+}
+
+void server_logger::batch_sender::release_spool() noexcept {
+    if (_spool_lock != nullptr) {
+        CloseHandle(static_cast<HANDLE>(_spool_lock));
+        _spool_lock = nullptr;
+    }
+}
+
+#else
+
+bool server_logger::batch_sender::try_lock_spool(const std::string &lock_path) {
+    int fd = ::open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    // previous owner removes lock file before unlocking it, lock taken on removed file guards nothing
+    struct stat opened{}, current{};
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0 || fstat(fd, &opened) != 0 || ::stat(lock_path.c_str(), &current) != 0 ||
+        opened.st_dev != current.st_dev || opened.st_ino != current.st_ino) {
+        ::close(fd);
+        return false;
+    }
+
+    _spool_lock = fd;
+    return true;
+}
+
+void server_logger::batch_sender::release_spool() noexcept {
+    if (_spool_lock >= 0) {
+        ::unlink((_spool_path + ".lock").c_str());
+        ::close(_spool_lock);
+        _spool_lock = -1;
+    }
+}
+
+#endif
+
+void server_logger::batch_sender::update_backoff(bool delivered) {
+    if (delivered) {
+        _retry_delay = min_retry_delay;
+        _next_retry = std::chrono::steady_clock::time_point();
+        return;
+    }
+
+    _next_retry = std::chrono::steady_clock::now() + _retry_delay;
+    _retry_delay = std::min(_retry_delay * 2, max_retry_delay);
+}
+
+void server_logger::batch_sender::stop() {
+    {
+        std::lock_guard lock(_mut);
+        _stopped = true;
+    }
+    _cv.notify_one();
+    if (_worker.joinable()) {
+        _worker.join();
+    }
+}
+
+void server_logger::batch_sender::get(const std::string &url) {
+    std::lock_guard lock(_client_mut);
+    auto res = _client.Get(url);
+}
+
+namespace {
+    void append_json_string(std::string &out, std::string_view value) {
+        static constexpr char hex[] = "0123456789abcdef";
+
+        out += '"';
+        for (char c: value) {
+            switch (c) {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        out += "\\u00";
+                        out += hex[static_cast<unsigned char>(c) >> 4];
+                        out += hex[static_cast<unsigned char>(c) & 0xF];
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+}
+
+void server_logger::batch_sender::push(std::string_view severity, std::string_view message) {
+    bool is_full;
+    {
+        std::lock_guard lock(_mut);
+        _pending += "{\"sev\":";
+        append_json_string(_pending, severity);
+        _pending += ",\"message\":";
+        append_json_string(_pending, message);
+        _pending += "}\n";
+        is_full = ++_pending_count >= _max_batch_size;
+    }
+
+    if (is_full) {
+        _cv.notify_one();
+    }
+}
+
+void server_logger::batch_sender::run() {
+    std::unique_lock lock(_mut);
+    while (true) {
+        _cv.wait_for(lock, _flush_interval, [this] { return _stopped || _pending_count >= _max_batch_size; });
+
+        if (_pending_count > 0) {
+            std::string body;
+            body.swap(_pending);
+            size_t count = _pending_count;
+            _pending_count = 0;
+
+            lock.unlock();
+            send(body, count);
+            lock.lock();
+        } else if (_spooled_messages > 0 && std::chrono::steady_clock::now() >= _next_retry) {
+            lock.unlock();
+            replay_spool();
+            lock.lock();
+        }
+
+        if (_stopped && _pending_count == 0) {
+            return;
+        }
+    }
+}
+
+bool server_logger::batch_sender::register_streams() {
+    for (const auto &url: _init_urls) {
+        auto res = _client.Get(url);
+        if (!res || res->status < 200 || res->status >= 300) {
+            return false;
+        }
+    }
+    return true;
+}
+
+server_logger::batch_sender::delivery server_logger::batch_sender::post(const std::string &body) {
+    std::lock_guard lock(_client_mut);
+
+    // second attempt is made only if server didn't know pid and streams were registered again
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (!_registered && !(_registered = register_streams())) {
+            return delivery::failed;
+        }
+
+        auto res = _client.Post("/log_batch?pid=" + _pid, body, "application/x-ndjson");
+        if (!res || res->status >= 500) {
+            // server may have restarted meanwhile, so streams are registered again before next post
+            _registered = false;
+            return delivery::failed;
+        }
+        if (res->status >= 200 && res->status < 300) {
+            return delivery::delivered;
+        }
+        if (res->status != 404) {
+            return delivery::rejected;
+        }
+
+        _registered = false;
+    }
+
+    return delivery::rejected;
+}
+
+void server_logger::batch_sender::send(const std::string &body, size_t count) {
+    // while spool is not empty new batches go behind it, so that order is kept,
+    // and until backoff expires they do so without another attempt to reach server
+    if (_spooled_messages > 0 && (std::chrono::steady_clock::now() < _next_retry || !replay_spool())) {
+        spool(body, count);
+        return;
+    }
+
+    auto result = post(body);
+    update_backoff(result != delivery::failed);
+    switch (result) {
+        case delivery::delivered:
+            break;
+        case delivery::rejected:
+            _dropped_messages += count;
+            break;
+        case delivery::failed:
+            spool(body, count);
+    }
+}
+
+void server_logger::batch_sender::spool(const std::string &body, size_t count) {
+    if (_spool_path.empty() || _spooled_bytes + body.size() > _spool_max_bytes) {
+        _dropped_messages += count;
+        return;
+    }
+
+    std::ofstream file(_spool_path, std::ios_base::binary | std::ios_base::app);
+    if (!file.is_open() || !file.write(body.data(), static_cast<std::streamsize>(body.size()))) {
+        _dropped_messages += count;
+        return;
+    }
+
+    _spooled_bytes += body.size();
+    _spooled_messages += count;
+}
+
+bool server_logger::batch_sender::replay_spool() {
+    std::string content;
+    {
+        std::ifstream file(_spool_path, std::ios_base::binary);
+        if (!file.is_open()) {
+            _spooled_messages = 0;
+            _spooled_bytes = 0;
+            return true;
+        }
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    auto begin_time = std::chrono::steady_clock::now();
+    size_t replayed = 0;
+    size_t rejected = 0;
+    size_t sent_bytes = 0;
+
+    while (sent_bytes < content.size()) {
+        size_t end = sent_bytes, count = 0;
+        while (end < content.size() && count < _max_batch_size) {
+            end = content.find('\n', end);
+            end = end == std::string::npos ? content.size() : end + 1;
+            ++count;
+        }
+
+        auto result = post(content.substr(sent_bytes, end - sent_bytes));
+        update_backoff(result != delivery::failed);
+        if (result == delivery::failed) {
+            break;
+        }
+
+        // rejected batch would block everything behind it, so it is dropped
+        sent_bytes = end;
+        if (result == delivery::delivered) {
+            replayed += count;
+        } else {
+            rejected += count;
+        }
+    }
+
+    _dropped_messages += rejected;
+
+    if (replayed > 0) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin_time;
+        _replayed_messages += replayed;
+        _replay_rate = elapsed.count() > 0 ? static_cast<double>(replayed) / elapsed.count() : 0;
+    }
+
+    if (sent_bytes == content.size()) {
+        std::filesystem::remove(_spool_path);
+        _spooled_messages = 0;
+        _spooled_bytes = 0;
+        return true;
+    }
+
+    if (sent_bytes > 0) {
+        std::ofstream file(_spool_path, std::ios_base::binary | std::ios_base::trunc);
+        file.write(content.data() + sent_bytes, static_cast<std::streamsize>(content.size() - sent_bytes));
+        _spooled_messages -= std::min<size_t>(replayed + rejected, _spooled_messages);
+        _spooled_bytes = content.size() - sent_bytes;
+    }
+
+    return false;
+}
+
+server_logger::spool_metrics server_logger::batch_sender::metrics() const noexcept {
+    return {_spooled_messages.load(), _spooled_bytes.load(), _replayed_messages.load(),
+            _dropped_messages.load(), _replay_rate.load()};
+}
+
 server_logger::~server_logger() noexcept {
+    if (_sender == nullptr) {
+        return;
+    }
+
+    if (_throttle != nullptr) {
+        for (auto &[severity, suppressed]: _throttle->take_suppressed()) {
+            _sender->push(severity_to_string(severity), make_format(log_throttle::report_message(suppressed), severity));
+        }
+    }
+
+    _sender->stop();
+
     std::string pid = std::to_string(inner_getpid());
-    auto res = _client.Get("/destroy?pid=" + pid);
+    _sender->get("/destroy?pid=" + pid);
 }
 
-logger &server_logger::log(const std::string &text, logger::severity severity) & {
-    std::string pid = std::to_string(inner_getpid());
-    std::string formatted_message = make_format(text, severity);
-    std::string url = "/log?pid=" + pid + "&sev=" + severity_to_string(severity) + "&message=" + formatted_message;
-    auto res = _client.Get(url);
+server_logger::spool_metrics server_logger::metrics() const noexcept {
+    return _sender == nullptr ? spool_metrics{} : _sender->metrics();
+}
+
+logger &server_logger::log(std::string_view text, logger::severity severity) & {
+    if (_sender == nullptr) {
+        return *this;
+    }
+
+    if (_throttle != nullptr) {
+        size_t suppressed = 0;
+        bool admitted = _throttle->admit(severity, suppressed);
+
+        if (suppressed != 0) {
+            _sender->push(severity_to_string(severity), make_format(log_throttle::report_message(suppressed), severity));
+        }
+        if (!admitted) {
+            return *this;
+        }
+    }
+
+    // reused between calls, so line is formatted without allocation once buffer has grown
+    thread_local std::string line;
+    line.clear();
+    append_format(line, text, severity);
+
+    _sender->push(severity_to_string(severity), line);
     return *this;
 }
 
-std::string server_logger::make_format(const std::string &message, severity sev) const {
-    std::stringstream formatted_message;
+std::string server_logger::make_format(std::string_view message, severity sev) const {
+    std::string result;
+    append_format(result, message, sev);
+    return result;
+}
+
+void server_logger::append_format(std::string &out, std::string_view message, severity sev) const {
+    std::time_t now = std::time(nullptr);
 
     for (size_t i = 0; i < _format.length(); ++i) {
         if (_format[i] == '%' && i + 1 < _format.length()) {
             switch (char_to_flag(_format[i + 1])) {
                 case flag::DATE:
-                    formatted_message << current_date_to_string();
+                    append_date(out, now);
                     break;
                 case flag::TIME:
-                    formatted_message << current_time_to_string();
+                    append_time(out, now);
                     break;
                 case flag::SEVERITY:
-                    formatted_message << severity_to_string(sev);
+                    out += severity_to_string(sev);
                     break;
                 case flag::MESSAGE:
-                    formatted_message << message;
+                    out += message;
                     break;
                 default:
-                    formatted_message << '%' << _format[i + 1];
+                    out += '%';
+                    out += _format[i + 1];
             }
             ++i;
         } else {
-            formatted_message << _format[i];
+            out += _format[i];
         }
     }
-    return formatted_message.str();
 }
 
 server_logger::flag server_logger::char_to_flag(char c) noexcept {
@@ -69,12 +491,18 @@ server_logger::flag server_logger::char_to_flag(char c) noexcept {
 }
 
 server_logger::server_logger(const std::string &dest, const std::unordered_map<logger::severity, std::pair<std::string, bool> > &streams,
-                             std::string format) : _client(dest), _streams(streams), _format(std::move(format)) {
+                             std::string format, size_t max_batch_size, std::chrono::milliseconds flush_interval,
+                             const std::string &spool_path, size_t spool_max_bytes,
+                             std::unique_ptr<log_throttle> throttle)
+        : _streams(streams), _format(std::move(format)), _throttle(std::move(throttle)) {
     std::string pid = std::to_string(inner_getpid());
+    std::vector<std::string> init_urls;
     for (const auto &[sev, stream_info]: streams) {
-        auto url = "/init?pid=" + pid + "&sev=" + severity_to_string(sev) + "&path=" + stream_info.first + "&console=" + std::to_string(+stream_info.second);
-        auto res = _client.Get(url);
+        init_urls.push_back("/init?pid=" + pid + "&sev=" + severity_to_string(sev) + "&path=" + stream_info.first + "&console=" + std::to_string(+stream_info.second));
     }
+
+    _sender = std::make_unique<batch_sender>(dest, pid, std::move(init_urls), max_batch_size, flush_interval,
+                                             spool_path, spool_max_bytes);
 }
 
 int server_logger::inner_getpid() {
@@ -85,12 +513,16 @@ int server_logger::inner_getpid() {
 #endif
 }
 
-server_logger::server_logger(server_logger &&other) noexcept : _client(std::move(other._client)), _format(std::move(other._format)) {}
+server_logger::server_logger(server_logger &&other) noexcept : _sender(std::move(other._sender)), _streams(std::move(other._streams)),
+                                                                 _format(std::move(other._format)),
+                                                                 _throttle(std::move(other._throttle)) {}
 
 server_logger &server_logger::operator=(server_logger &&other) noexcept {
     if (this != &other) {
-        _client = std::move(other._client);
+        _sender = std::move(other._sender);
+        _streams = std::move(other._streams);
         _format = std::move(other._format);
+        _throttle = std::move(other._throttle);
     }
 
     return *this;
@@ -44,6 +44,34 @@ logger_builder& server_logger_builder::transform_with_configuration(std::string
             set_format(js["format"]);
         }
 
+        if (js.contains("batch") && js["batch"].is_object()) {
+            auto& batch = js["batch"];
+            set_batching(batch.value("size", _max_batch_size),
+                         std::chrono::milliseconds(batch.value("interval_ms", _flush_interval.count())));
+        }
+
+        // "throttle": {"TRACE": {"sample": N, "rate_limit": {"rate": ..., "burst": ...}}, ...}
+        if (js.contains("throttle") && js["throttle"].is_object()) {
+            for (auto& [sev, item] : js["throttle"].items()) {
+                log_throttle::rule rule;
+                rule.sample = item.value("sample", rule.sample);
+                if (item.contains("rate_limit") && item["rate_limit"].is_object()) {
+                    rule.rate = item["rate_limit"].value("rate", rule.rate);
+                    rule.burst = item["rate_limit"].value("burst", rule.burst);
+                }
+                set_throttle(string_to_severity(sev), rule);
+            }
+        }
+
+        if (js.contains("throttle_report_interval_ms")) {
+            set_throttle_report_interval(std::chrono::milliseconds(js["throttle_report_interval_ms"].get<size_t>()));
+        }
+
+        if (js.contains("spool") && js["spool"].is_object()) {
+            auto& spool = js["spool"];
+            set_spool(spool.value("path", _spool_path), spool.value("max_bytes", _spool_max_bytes));
+        }
+
         if (js.contains("streams")) {
             for (auto& stream_item : js["streams"]) {
                 std::string type = stream_item["type"];
@@ -67,11 +95,26 @@ logger_builder& server_logger_builder::transform_with_configuration(std::string
 logger_builder& server_logger_builder::clear() & {
     _output_streams.clear();
     _destination = "http://127.0.0.1:9200";
+    _max_batch_size = 64;
+    _flush_interval = std::chrono::milliseconds(100);
+    _spool_path = "server_logger.spool";
+    _spool_max_bytes = 16 * 1024 * 1024;
+    _throttle_rules.clear();
+    _throttle_report_interval = std::chrono::seconds(10);
     return *this;
 }
 
 logger* server_logger_builder::build() const {
-    return new server_logger(_destination, _output_streams, _format);
+    std::unique_ptr<log_throttle> throttle;
+    if (!_throttle_rules.empty()) {
+        throttle = std::make_unique<log_throttle>(_throttle_report_interval);
+        for (auto& [severity, rule] : _throttle_rules) {
+            throttle->set_rule(severity, rule);
+        }
+    }
+
+    return new server_logger(_destination, _output_streams, _format, _max_batch_size, _flush_interval,
+                             _spool_path, _spool_max_bytes, std::move(throttle));
 }
 
 logger_builder& server_logger_builder::set_destination(const std::string& dest) & {
@@ -82,4 +125,26 @@ logger_builder& server_logger_builder::set_destination(const std::string& dest)
 logger_builder& server_logger_builder::set_format(const std::string& format) & {
     _format = format;
     return *this;
+}
+
+server_logger_builder& server_logger_builder::set_batching(size_t max_batch_size, std::chrono::milliseconds flush_interval) & {
+    _max_batch_size = max_batch_size;
+    _flush_interval = flush_interval;
+    return *this;
+}
+
+server_logger_builder& server_logger_builder::set_spool(const std::string& path, size_t max_bytes) & {
+    _spool_path = path;
+    _spool_max_bytes = max_bytes;
+    return *this;
+}
+
+server_logger_builder& server_logger_builder::set_throttle(logger::severity severity, log_throttle::rule const& rule) & {
+    _throttle_rules[severity] = rule;
+    return *this;
+}
+
+server_logger_builder& server_logger_builder::set_throttle_report_interval(std::chrono::milliseconds interval) & {
+    _throttle_report_interval = interval;
+    return *this;
 }
\ No newline at end of file
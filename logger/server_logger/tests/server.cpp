@@ -5,29 +5,106 @@
 #include "server.h"
 
 #include <logger_builder.h>
+#include <nlohmann/json.hpp>
 
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 
+server::file_writer::file_writer(const std::string &path) : _stream(path, std::ios_base::app), _stopped(false) {
+    _worker = std::thread(&file_writer::run, this);
+}
 
-server::server(uint16_t port) {
+server::file_writer::~file_writer() noexcept {
+    {
+        std::lock_guard lock(_mut);
+        _stopped = true;
+    }
+    _cv.notify_one();
+    _worker.join();
+}
+
+void server::file_writer::push(std::string_view lines) {
+    {
+        std::lock_guard lock(_mut);
+        _pending += lines;
+    }
+    _cv.notify_one();
+}
+
+void server::file_writer::run() {
+    std::string buffer;
+
+    std::unique_lock lock(_mut);
+    while (true) {
+        _cv.wait(lock, [this] { return _stopped || !_pending.empty(); });
+
+        if (!_pending.empty()) {
+            buffer.swap(_pending);
+
+            lock.unlock();
+            if (_stream.is_open()) {
+                _stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                _stream.flush();
+            }
+            buffer.clear();
+            lock.lock();
+        }
+
+        if (_stopped && _pending.empty()) {
+            return;
+        }
+    }
+}
+
+server::shard &server::shard_of(int pid) noexcept {
+    return _shards[static_cast<unsigned int>(pid) % shards_count];
+}
+
+server::file_writer &server::writer_of(const std::string &path) {
+    {
+        std::shared_lock lock(_writers_mut);
+        auto it = _writers.find(path);
+        if (it != _writers.end()) {
+            return *it->second;
+        }
+    }
+
+    std::lock_guard lock(_writers_mut);
+    auto it = _writers.find(path);
+    if (it == _writers.end()) {
+        it = _writers.emplace(path, std::make_unique<file_writer>(path)).first;
+    }
+    return *it->second;
+}
+
+void server::write_to_console(std::string_view lines) {
+    std::lock_guard lock(_console_mut);
+    std::cout << lines << std::flush;
+}
+
+server::server(uint16_t port, bool verbose) : _verbose(verbose) {
     CROW_ROUTE(app, "/init")([&](const crow::request &req) {
         std::string pid_str = req.url_params.get("pid");
         std::string sev_str = req.url_params.get("sev");
         std::string path_str = req.url_params.get("path");
         std::string console_str = req.url_params.get("console");
 
-        std::cout << "INIT PID: " << pid_str << " SEVERITY: " << sev_str << " PATH: " << path_str << " CONSOLE: " << console_str << std::endl;
+        if (_verbose) {
+            write_to_console("INIT PID: " + pid_str + " SEVERITY: " + sev_str + " PATH: " + path_str + " CONSOLE: " + console_str + "\n");
+        }
 
         int pid = std::stoi(pid_str);
         logger::severity sev = logger_builder::string_to_severity(sev_str);
         bool console = console_str == "1";
 
-        std::lock_guard lock(_mut);
-        auto it = _streams.find(pid);
+        shard &sh = shard_of(pid);
+        std::lock_guard lock(sh.mut);
+        auto it = sh.streams.find(pid);
 
-        if (it == _streams.end()) {
-            it = _streams.emplace(pid, std::unordered_map<logger::severity, std::pair<std::string, bool>>()).first;
+        if (it == sh.streams.end()) {
+            it = sh.streams.emplace(pid, pid_streams()).first;
         }
 
         auto inner_it = it->second.find(sev);
@@ -45,12 +122,15 @@ server::server(uint16_t port) {
     CROW_ROUTE(app, "/destroy")([&](const crow::request &req) {
         std::string pid_str = req.url_params.get("pid");
 
-        std::cout << "DESTROY PID: " << pid_str << std::endl;
+        if (_verbose) {
+            write_to_console("DESTROY PID: " + pid_str + "\n");
+        }
 
         int pid = std::stoi(pid_str);
 
-        std::lock_guard lock(_mut);
-        _streams.erase(pid);
+        shard &sh = shard_of(pid);
+        std::lock_guard lock(sh.mut);
+        sh.streams.erase(pid);
 
         return crow::response(204);
     });
@@ -60,34 +140,141 @@ server::server(uint16_t port) {
         std::string sev_str = req.url_params.get("sev");
         std::string message = req.url_params.get("message");
 
-        std::cout << "LOG PID: " << pid_str << " SEVERITY: " << sev_str << " MESSAGE: " << message << std::endl;
+        if (_verbose) {
+            write_to_console("LOG PID: " + pid_str + " SEVERITY: " + sev_str + " MESSAGE: " + message + "\n");
+        }
 
         int pid = std::stoi(pid_str);
         logger::severity sev = logger_builder::string_to_severity(sev_str);
 
-        std::shared_lock lock(_mut);
-        auto it = _streams.find(pid);
-        if (it != _streams.end()) {
+        std::pair<std::string, bool> destination;
+        {
+            shard &sh = shard_of(pid);
+            std::shared_lock lock(sh.mut);
+            auto it = sh.streams.find(pid);
+            if (it == sh.streams.end()) {
+                return crow::response(204);
+            }
+
             auto inner_it = it->second.find(sev);
+            if (inner_it == it->second.end()) {
+                return crow::response(204);
+            }
+
+            destination = inner_it->second;
+        }
 
-            if (inner_it != it->second.end()) {
-                const std::string &path = inner_it->second.first;
-                if (!path.empty()) {
-                    std::ofstream stream(path, std::ios_base::app);
-                    if (stream.is_open()) {
-                        stream << message << std::endl;
-                    }
-                }
-
-                if (inner_it->second.second) {
-                    std::cout << message << std::endl;
-                }
+        message += '\n';
+        if (!destination.first.empty()) {
+            writer_of(destination.first).push(message);
+        }
+
+        if (destination.second) {
+            write_to_console(message);
+        }
+
+        return crow::response(204);
+    });
+
+    CROW_ROUTE(app, "/log_batch").methods(crow::HTTPMethod::POST)([&](const crow::request &req) {
+        // client retries batches answered with 5xx, so malformed input must be answered with 400, not thrown
+        const char *pid_param = req.url_params.get("pid");
+        std::string pid_str = pid_param == nullptr ? std::string() : pid_param;
+
+        int pid;
+        try {
+            pid = std::stoi(pid_str);
+        } catch (const std::logic_error &) {
+            return crow::response(400);
+        }
+
+        pid_streams streams;
+        {
+            shard &sh = shard_of(pid);
+            std::shared_lock lock(sh.mut);
+            auto it = sh.streams.find(pid);
+            if (it == sh.streams.end()) {
+                // client registered before server restart, it has to send /init again
+                return crow::response(404);
             }
+            streams = it->second;
         }
+
+        std::unordered_map<std::string, std::string> files;
+        std::string console;
+        size_t count = 0;
+
+        std::istringstream body(req.body);
+        std::string line;
+        while (std::getline(body, line)) {
+            if (line.empty()) continue;
+
+            auto record = nlohmann::json::parse(line, nullptr, false);
+            if (record.is_discarded() || !record.is_object() || !record.contains("sev") || !record["sev"].is_string() ||
+                !record.contains("message") || !record["message"].is_string()) {
+                return crow::response(400);
+            }
+            ++count;
+
+            logger::severity sev;
+            try {
+                sev = logger_builder::string_to_severity(record["sev"].get<std::string>());
+            } catch (const std::out_of_range &) {
+                return crow::response(400);
+            }
+            auto inner_it = streams.find(sev);
+            if (inner_it == streams.end()) continue;
+
+            const std::string &message = record["message"].get_ref<const std::string &>();
+            const std::string &path = inner_it->second.first;
+            if (!path.empty()) {
+                std::string &lines = files[path];
+                lines += message;
+                lines += '\n';
+            }
+
+            if (inner_it->second.second) {
+                console += message;
+                console += '\n';
+            }
+        }
+
+        for (auto &[path, lines]: files) {
+            writer_of(path).push(lines);
+        }
+
+        if (!console.empty()) {
+            write_to_console(console);
+        }
+
+        if (_verbose) {
+            write_to_console("LOG_BATCH PID: " + pid_str + " COUNT: " + std::to_string(count) + "\n");
+        }
+
         return crow::response(204);
     });
 
 
     app.port(port).loglevel(crow::LogLevel::Warning).multithreaded();
+}
+
+server::~server() noexcept {
+    stop();
+}
+
+void server::run() {
     app.run();
-}
\ No newline at end of file
+}
+
+void server::start() {
+    _running = app.run_async();
+    app.wait_for_server_start();
+}
+
+void server::stop() {
+    if (_running.valid()) {
+        app.stop();
+        _running.wait();
+        _running = {};
+    }
+}
@@ -6,29 +6,100 @@
 #define MP_OS_SERVER_H
 
 #include <crow.h>
+#include <array>
+#include <condition_variable>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <logger.h>
 #include <shared_mutex>
 
 class server
 {
+    using pid_streams = std::unordered_map<logger::severity, std::pair<std::string, bool>>;
+
+    /** Streams of clients are split by pid, so requests of different clients don't contend on one lock
+     */
+    struct shard
+    {
+        std::shared_mutex mut;
+        std::unordered_map<int, pid_streams> streams;
+    };
+
+    static constexpr size_t shards_count = 64;
+
+    /** Owns opened file and writes everything pushed to it from its own thread
+     */
+    class file_writer
+    {
+        std::ofstream _stream;
+
+        std::mutex _mut;
+        std::condition_variable _cv;
+        std::string _pending;
+        bool _stopped;
+
+        std::thread _worker;
+
+        void run();
+
+    public:
+
+        explicit file_writer(const std::string &path);
+
+        file_writer(const file_writer&) = delete;
+        file_writer& operator=(const file_writer&) = delete;
+        file_writer(file_writer&&) noexcept = delete;
+        file_writer& operator=(file_writer&&) noexcept = delete;
+
+        //lines must be '\n'-terminated
+        void push(std::string_view lines);
+
+        ~file_writer() noexcept;
+    };
+
+    std::array<shard, shards_count> _shards;
+
+    std::unordered_map<std::string, std::unique_ptr<file_writer>> _writers;
+    std::shared_mutex _writers_mut;
+
+    std::mutex _console_mut;
+
+    // every request is echoed to console, which serializes handlers on stdout
+    bool _verbose;
 
     crow::SimpleApp app;
 
-    std::unordered_map<int, std::unordered_map<logger::severity, std::pair<std::string, bool>>> _streams;
+    // set while server runs in background after start()
+    std::future<void> _running;
 
-    std::shared_mutex _mut;
+    shard &shard_of(int pid) noexcept;
+
+    file_writer &writer_of(const std::string &path);
+
+    void write_to_console(std::string_view lines);
 
 public:
 
-    explicit server(uint16_t port = 9200);
+    explicit server(uint16_t port = 9200, bool verbose = false);
+
+    //serves requests on calling thread until stop()
+    void run();
+
+    //serves requests in background, returns once server accepts connections
+    void start();
+
+    void stop();
 
     server(const server&) = delete;
     server& operator=(const server&) = delete;
     server(server&&) noexcept = delete;
     server& operator=(server&&) noexcept = delete;
-    ~server() noexcept = default;
+    ~server() noexcept;
 };
 
 
-#endif //MP_OS_SERVER_H
\ No newline at end of file
+#endif //MP_OS_SERVER_H
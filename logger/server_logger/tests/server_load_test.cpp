@@ -0,0 +1,73 @@
+//
+// Load test for server: start serv_test first, then run
+// serv_load_test [clients = 16] [batches per client = 200] [batch size = 64] [files = 4] [port = 9200]
+//
+
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char *argv[])
+{
+    size_t clients = argc > 1 ? std::stoul(argv[1]) : 16;
+    size_t batches = argc > 2 ? std::stoul(argv[2]) : 200;
+    size_t batch_size = argc > 3 ? std::stoul(argv[3]) : 64;
+    size_t files = argc > 4 ? std::stoul(argv[4]) : 4;
+    std::string port = argc > 5 ? argv[5] : "9200";
+
+    std::string destination = "http://127.0.0.1:" + port;
+    std::atomic<size_t> failed = 0;
+
+    // every client pretends to be separate process, so its pid falls into its own shard
+    auto client_routine = [&](size_t index) {
+        httplib::Client client(destination);
+        client.set_keep_alive(true);
+
+        std::string pid = std::to_string(1000000 + index);
+        std::string path = "load_" + std::to_string(index % files) + ".txt";
+        client.Get("/init?pid=" + pid + "&sev=INFORMATION&path=" + path + "&console=0");
+
+        std::string body;
+        for (size_t i = 0; i < batch_size; ++i) {
+            body += nlohmann::json{{"sev", "INFORMATION"}, {"message", "client " + pid + " message " + std::to_string(i)}}.dump();
+            body += '\n';
+        }
+
+        for (size_t i = 0; i < batches; ++i) {
+            auto res = client.Post("/log_batch?pid=" + pid, body, "application/x-ndjson");
+            if (!res || res->status >= 300) {
+                ++failed;
+            }
+        }
+
+        client.Get("/destroy?pid=" + pid);
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < clients; ++i) {
+        threads.emplace_back(client_routine, i);
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    size_t total = clients * batches * batch_size;
+
+    std::cout << nlohmann::json{
+            {"clients", clients},
+            {"messages", total},
+            {"failed_batches", failed.load()},
+            {"seconds", elapsed.count()},
+            {"messages_per_second", static_cast<double>(total) / elapsed.count()}}.dump() << std::endl;
+
+    return failed == 0 ? 0 : 1;
+}
@@ -1,19 +1,208 @@
+#include <gtest/gtest.h>
 #include "server.h"
 #include <server_logger_builder.h>
 
-int main()
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace
+{
+    constexpr uint16_t test_port = 9201;
+    const std::string test_destination = "http://127.0.0.1:9201";
+
+    std::vector<std::string> read_lines(const std::string &path)
+    {
+        std::vector<std::string> lines;
+        std::ifstream stream(path);
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    // server writes files from its own thread, so results are polled
+    template<typename predicate>
+    bool wait_for(predicate condition)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!condition())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+}
+
+TEST(spool, messages_logged_while_server_is_down_are_replayed_in_order)
 {
+    std::filesystem::remove("restart.txt");
+    std::filesystem::remove("restart.spool");
 
+    auto srv = std::make_unique<server>(test_port);
+    srv->start();
 
     server_logger_builder builder;
+    builder.set_batching(4, std::chrono::milliseconds(20)).set_spool("restart.spool", 1024 * 1024);
+    builder.set_destination(test_destination).set_format("%m").add_file_stream("restart.txt", logger::severity::information);
+    std::unique_ptr<logger> log(builder.build());
+    auto &sender = dynamic_cast<server_logger &>(*log);
+
+    std::vector<std::string> expected;
+    auto log_lines = [&](const std::string &prefix)
+    {
+        for (size_t i = 0; i < 8; ++i)
+        {
+            expected.push_back(prefix + std::to_string(i));
+            log->information(expected.back());
+        }
+    };
+
+    log_lines("before ");
+    ASSERT_TRUE(wait_for([&] { return read_lines("restart.txt").size() == expected.size(); }));
+
+    srv.reset();
+    log_lines("down ");
+    ASSERT_TRUE(wait_for([&] { return sender.metrics().depth_messages == 8u; }));
 
-    builder.add_file_stream("a.txt", logger::severity::trace).add_file_stream("b.txt", logger::severity::debug).
-            add_console_stream(logger::severity::trace).add_file_stream("a.txt", logger::severity::information);
+    // restarted server knows nothing about this client until it registers its streams again
+    srv = std::make_unique<server>(test_port);
+    srv->start();
+    ASSERT_TRUE(wait_for([&] { return sender.metrics().depth_messages == 0; }));
+    EXPECT_EQ(sender.metrics().replayed_messages, 8u);
 
+    // restart with nothing to replay, first batch after it either fails or is answered with unknown pid
+    srv.reset();
+    srv = std::make_unique<server>(test_port);
+    srv->start();
+    log_lines("after ");
+    ASSERT_TRUE(wait_for([&] { return read_lines("restart.txt").size() == expected.size(); }));
+
+    auto metrics = sender.metrics();
+    EXPECT_EQ(metrics.depth_messages, 0u);
+    EXPECT_EQ(metrics.depth_bytes, 0u);
+    EXPECT_EQ(metrics.dropped_messages, 0u);
+
+    log.reset();
+    srv.reset();
+
+    EXPECT_EQ(read_lines("restart.txt"), expected);
+    EXPECT_FALSE(std::filesystem::exists("restart.spool"));
+}
+
+TEST(batching, full_batch_is_sent_without_waiting_for_interval)
+{
+    std::filesystem::remove("size_info.txt");
+    std::filesystem::remove("size_error.txt");
+
+    server srv(test_port);
+    srv.start();
+
+    // interval is far longer than wait_for timeout, so only batch size can trigger the flush
+    server_logger_builder builder;
+    builder.set_batching(6, std::chrono::minutes(10)).set_spool("", 0);
+    builder.set_destination(test_destination).set_format("[%s] %m").
+            add_file_stream("size_info.txt", logger::severity::information).
+            add_file_stream("size_error.txt", logger::severity::error);
     std::unique_ptr<logger> log(builder.build());
 
-    log->trace("good").debug("debug");
+    log->information("first").error("second").debug("not routed").information("third").error("fourth").information("fifth");
+
+    std::vector<std::string> info = {"[INFORMATION] first", "[INFORMATION] third", "[INFORMATION] fifth"};
+    std::vector<std::string> error = {"[ERROR] second", "[ERROR] fourth"};
+    ASSERT_TRUE(wait_for([&] { return read_lines("size_info.txt").size() == info.size() &&
+                                      read_lines("size_error.txt").size() == error.size(); }));
+    EXPECT_EQ(read_lines("size_info.txt"), info);
+    EXPECT_EQ(read_lines("size_error.txt"), error);
+}
+
+TEST(batching, partial_batch_is_sent_after_interval)
+{
+    std::filesystem::remove("time_info.txt");
+    std::filesystem::remove("time_error.txt");
+
+    server srv(test_port);
+    srv.start();
+
+    server_logger_builder builder;
+    builder.set_batching(1000, std::chrono::milliseconds(50)).set_spool("", 0);
+    builder.set_destination(test_destination).set_format("[%s] %m").
+            add_file_stream("time_info.txt", logger::severity::information).
+            add_file_stream("time_error.txt", logger::severity::error);
+    std::unique_ptr<logger> log(builder.build());
+
+    std::vector<std::string> info, error;
+    for (size_t i = 0; i < 10; ++i)
+    {
+        std::string message = std::to_string(i);
+        if (i % 3 == 0)
+        {
+            log->error(message);
+            error.push_back("[ERROR] " + message);
+        }
+        else
+        {
+            log->information(message).trace("not routed");
+            info.push_back("[INFORMATION] " + message);
+        }
+    }
+
+    ASSERT_TRUE(wait_for([&] { return read_lines("time_info.txt").size() == info.size() &&
+                                      read_lines("time_error.txt").size() == error.size(); }));
+    EXPECT_EQ(read_lines("time_info.txt"), info);
+    EXPECT_EQ(read_lines("time_error.txt"), error);
+
+    auto metrics = dynamic_cast<server_logger &>(*log).metrics();
+    EXPECT_EQ(metrics.dropped_messages, 0u);
+}
+
+TEST(spool, loggers_with_same_spool_path_keep_separate_spools)
+{
+    for (auto path: {"shared_a.txt", "shared_b.txt", "shared.spool", "shared.spool.1"})
+    {
+        std::filesystem::remove(path);
+    }
+
+    // both loggers are built while server is down, so everything they log goes through their spools
+    server_logger_builder builder_a, builder_b;
+    builder_a.set_batching(4, std::chrono::milliseconds(20)).set_spool("shared.spool", 1024 * 1024);
+    builder_a.set_destination(test_destination).set_format("%m").add_file_stream("shared_a.txt", logger::severity::information);
+    builder_b.set_batching(4, std::chrono::milliseconds(20)).set_spool("shared.spool", 1024 * 1024);
+    builder_b.set_destination(test_destination).set_format("%m").add_file_stream("shared_b.txt", logger::severity::error);
+
+    std::unique_ptr<logger> log_a(builder_a.build()), log_b(builder_b.build());
+    auto &sender_a = dynamic_cast<server_logger &>(*log_a);
+    auto &sender_b = dynamic_cast<server_logger &>(*log_b);
+
+    std::vector<std::string> expected_a, expected_b;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        expected_a.push_back("a " + std::to_string(i));
+        expected_b.push_back("b " + std::to_string(i));
+        log_a->information(expected_a.back());
+        log_b->error(expected_b.back());
+    }
+
+    ASSERT_TRUE(wait_for([&] { return sender_a.metrics().depth_messages == 8u && sender_b.metrics().depth_messages == 8u; }));
+    EXPECT_TRUE(std::filesystem::exists("shared.spool"));
+    EXPECT_TRUE(std::filesystem::exists("shared.spool.1"));
+
+    auto srv = std::make_unique<server>(test_port);
+    srv->start();
+    ASSERT_TRUE(wait_for([&] { return sender_a.metrics().depth_messages == 0 && sender_b.metrics().depth_messages == 0; }));
+
+    log_a.reset();
+    log_b.reset();
+    srv.reset();
 
-    log->trace("IT is a very long strange message !!!!!!!!!!%%%%%%%%\tzdtjhdjh").
-		information("bfldknbpxjxjvpxvjbpzjbpsjbpsjkgbpsejegpsjpegesjpvbejpvjzepvgjs");
-}
\ No newline at end of file
+    EXPECT_EQ(read_lines("shared_a.txt"), expected_a);
+    EXPECT_EQ(read_lines("shared_b.txt"), expected_b);
+    EXPECT_FALSE(std::filesystem::exists("shared.spool.lock"));
+}
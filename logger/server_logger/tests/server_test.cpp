@@ -3,7 +3,11 @@
 //
 #include "server.h"
 
+#include <string_view>
+
+// serv_test [-v], -v prints every request
 int main(int argc, char* argv[])
 {
-    server s;
+    server s(9200, argc > 1 && std::string_view(argv[1]) == "-v");
+    s.run();
 }
\ No newline at end of file